@@ -0,0 +1,443 @@
+/**
+* @file Benchmarks.cpp
+* @brief Contains InterfaceMonitor benchmarks. Updates come from a synthetic backend,
+*  so NetworkManager is not required. Only the cold start and the D-Bus message counts
+*  use it and are skipped without it.
+*
+* Bench exec example:
+* ./interfaceMonitorBenchmarks
+*/
+
+#include "InterfaceMonitor.h"
+#include "BasicInterfaceManager.h"
+
+#include <atomic>
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <gio/gio.h>
+#include <boost/chrono.hpp>
+#include <boost/format.hpp>
+
+typedef boost::chrono::steady_clock benchClock;
+
+#define BENCH_INTERFACE_COUNT   256
+#define BENCH_EVENT_COUNT       200000
+#define BENCH_COLD_START_RUNS   20
+#define BENCH_SYSFS_INTERFACES  10000
+#define BENCH_SYSFS_SCANS       20
+#define BENCH_DBUS_RUNS         20
+
+////////////////////////////////////////////////////////////
+///////            SyntheticImpl                  //////////
+////////////////////////////////////////////////////////////
+
+/**
+* @class SyntheticImpl
+* @brief Emits a fixed number of add/remove updates as fast as possible,
+*  every interface alternates between being added and removed
+*/
+
+class SyntheticImpl final : public AbstractInterfaceManagerImpl
+{
+public:
+    SyntheticImpl(const size_t& eventCount, const size_t& interfaceCount) :
+        mEventCount(eventCount),
+        mInterfaceCount(interfaceCount)
+    {
+        for(size_t i = 0; i < mInterfaceCount; ++i)
+        {
+            InterfaceInfo info;
+            info.id = (boost::format("/org/freedesktop/NetworkManager/Devices/%d") % i).str();
+            info.name = (boost::format("veth%d") % i).str();
+            info.hwAddr = "00:11:22:33:44:55";
+            info.type = IF_TYPE_ETH;
+            mInfos.push_back(info);
+        }
+    }
+
+    void startListening()
+    {
+        for(size_t i = 0; i < mEventCount; ++i)
+        {
+            /**< The n-th update of an interface is an addition if n is even */
+            size_t index = i % mInterfaceCount;
+            reportUpdate(mInfos[index], (i / mInterfaceCount) % 2 == 0);
+        }
+    }
+
+    void stopListening(){}
+    void updateDevices()
+    {
+        unique_lock lock(mMutex);
+
+        for(auto& info : mInfos){
+            mInterfaces[info.id] = info;
+        }
+    }
+    bool updateDevice(const std::string& deviceId){ return true; }
+
+private:
+    size_t mEventCount;
+    size_t mInterfaceCount;
+    std::vector<InterfaceInfo> mInfos;
+};
+
+////////////////////////////////////////////////////////////
+///////            Thread scaling                 //////////
+////////////////////////////////////////////////////////////
+
+/**
+* Updates pass through InterfaceManager to an event loop run by threadCount threads,
+* the handler serializes each update as the monitor does. Returns updates per second,
+* orderViolations counts updates of an interface delivered out of order
+*/
+double benchThreadScaling(const uint& threadCount, size_t& orderViolations)
+{
+    io_service eventLoop;
+    io_service::work work(eventLoop);
+
+    std::map<std::string, size_t> indexes;
+    std::vector<size_t> updateCounts(BENCH_INTERFACE_COUNT, 0);   /**< Each element is only touched by its interface strand */
+    std::atomic<size_t> handled(0);
+    std::atomic<size_t> violations(0);
+
+    SyntheticImpl* impl = new SyntheticImpl(BENCH_EVENT_COUNT, BENCH_INTERFACE_COUNT);
+    InterfaceManager manager(eventLoop, ImplPtr(impl));
+
+    for(size_t i = 0; i < BENCH_INTERFACE_COUNT; ++i){
+        indexes[(boost::format("/org/freedesktop/NetworkManager/Devices/%d") % i).str()] = i;
+    }
+
+    manager.interfaceUpdateSignal.connect([&](const InterfaceInfo& info, const bool& action)
+    {
+        std::string message = InterfaceSerializer::serializeUpdate(info, action);
+
+        size_t& count = updateCounts[indexes.find(info.id)->second];
+        if(action != (count % 2 == 0) || message.empty()){
+            ++violations;
+        }
+
+        ++count;
+
+        if(++handled == BENCH_EVENT_COUNT){
+            eventLoop.stop();
+        }
+    });
+
+    benchClock::time_point begin = benchClock::now();
+
+    boost::thread_group pool;
+    for(uint i = 0; i < threadCount; ++i){
+        pool.create_thread(boost::bind(&io_service::run, &eventLoop));
+    }
+
+    manager.startListening();
+    pool.join_all();
+
+    double seconds = boost::chrono::duration<double>(benchClock::now() - begin).count();
+    orderViolations = violations;
+
+    return BENCH_EVENT_COUNT / seconds;
+}
+
+////////////////////////////////////////////////////////////
+///////            Per-update overhead            //////////
+////////////////////////////////////////////////////////////
+
+/**
+* @class CountingHandler
+* @brief Counts updates and stops the event loop after the last one
+*/
+
+class CountingHandler
+{
+public:
+    CountingHandler(io_service& io, const size_t& expected) : mEventLoop(io), mExpected(expected), mHandled(0){}
+
+    void onInterfaceUpdate(const InterfaceInfo& info, const bool& action)
+    {
+        if(++mHandled == mExpected){
+            mEventLoop.stop();
+        }
+    }
+
+    void onInterfaceEvent(const InterfaceEvent& event)
+    {
+        if(++mHandled == mExpected){
+            mEventLoop.stop();
+        }
+    }
+
+    void onUpdateFailed(){}
+
+private:
+    io_service& mEventLoop;
+    size_t mExpected;
+    std::atomic<size_t> mHandled;
+};
+
+/**< Runs the loop until the handler has seen all updates, returns nsec per update */
+template <class Manager>
+double measureUpdates(io_service& eventLoop, Manager& manager)
+{
+    io_service::work work(eventLoop);
+    benchClock::time_point begin = benchClock::now();
+
+    manager.startListening();
+    eventLoop.run();
+
+    return boost::chrono::duration<double, boost::nano>(benchClock::now() - begin).count() / BENCH_EVENT_COUNT;
+}
+
+double benchRuntimeManager()
+{
+    io_service eventLoop;
+    CountingHandler handler(eventLoop, BENCH_EVENT_COUNT);
+
+    InterfaceManager manager(eventLoop, ImplPtr(new SyntheticImpl(BENCH_EVENT_COUNT, BENCH_INTERFACE_COUNT)));
+    manager.interfaceUpdateSignal.connect(boost::bind(&CountingHandler::onInterfaceUpdate, &handler, _1, _2));
+
+    return measureUpdates(eventLoop, manager);
+}
+
+template <class Dispatch>
+double benchBasicManager()
+{
+    io_service eventLoop;
+    CountingHandler handler(eventLoop, BENCH_EVENT_COUNT);
+
+    BasicInterfaceManager<SyntheticImpl, CountingHandler, Dispatch> manager(eventLoop, handler,
+                                                                          BENCH_EVENT_COUNT, BENCH_INTERFACE_COUNT);
+    return measureUpdates(eventLoop, manager);
+}
+
+////////////////////////////////////////////////////////////
+///////            sysfs scan                     //////////
+////////////////////////////////////////////////////////////
+
+/**< Builds a class directory with the given number of links to one ethernet device, returns its root */
+std::string makeSysfsTree(const size_t& interfaceCount)
+{
+    char rootTemplate[] = "/tmp/interfaceMonitorBenchXXXXXX";
+    if(mkdtemp(rootTemplate) == nullptr){
+        throw std::runtime_error("Error creating a temporary directory");
+    }
+
+    const std::string root = rootTemplate;
+    const std::string device = root + "/eth";
+    mkdir(device.c_str(), 0755);
+    mkdir((root + "/net").c_str(), 0755);
+
+    std::ofstream(device + "/type")<<"1"<<std::endl;
+    std::ofstream(device + "/address")<<"00:11:22:33:44:55"<<std::endl;
+    std::ofstream(device + "/uevent")<<"INTERFACE=eth"<<std::endl;
+
+    for(size_t i = 0; i < interfaceCount; ++i){
+        symlink(device.c_str(), (boost::format("%s/net/eth%d") % root % i).str().c_str());
+    }
+
+    return root;
+}
+
+/**< Returns usec for the first scan, which reads every interface, and for an unchanged scan */
+std::pair<double, double> benchSysfsScan(const std::string& path)
+{
+    SysfsInterfaceManagerImpl impl(path);
+
+    benchClock::time_point begin = benchClock::now();
+    impl.updateDevices();
+    double firstScan = boost::chrono::duration<double, boost::micro>(benchClock::now() - begin).count();
+
+    begin = benchClock::now();
+    for(size_t i = 0; i < BENCH_SYSFS_SCANS; ++i){
+        impl.poll();
+    }
+
+    return std::make_pair(firstScan,
+                          boost::chrono::duration<double, boost::micro>(benchClock::now() - begin).count() / BENCH_SYSFS_SCANS);
+}
+
+////////////////////////////////////////////////////////////
+///////            Cold start                     //////////
+////////////////////////////////////////////////////////////
+
+/**
+* Time until the first interface list is printed, including teardown.
+* The default flow starts listening (backend thread, GLib loop) and the print timer,
+* --once only enumerates and prints. Returns usec per run
+*/
+double benchColdStart(const std::function<ImplPtr ()>& createImpl, const bool& once)
+{
+    benchClock::time_point begin = benchClock::now();
+
+    for(uint i = 0; i < BENCH_COLD_START_RUNS; ++i)
+    {
+        io_service eventLoop;
+        std::ostringstream output;
+
+        InterfaceMonitor mon(eventLoop, 600000, createImpl(), &output);
+
+        if(once){
+            mon.printOnce();
+        }
+        else
+        {
+            mon.start();
+
+            while(output.tellp() <= 0 && eventLoop.run_one());
+            mon.stop();
+        }
+    }
+
+    return boost::chrono::duration<double, boost::micro>(benchClock::now() - begin).count() / BENCH_COLD_START_RUNS;
+}
+
+void reportColdStart(const std::string& backendName, const std::function<ImplPtr ()>& createImpl)
+{
+    try
+    {
+        double defaultFlow = benchColdStart(createImpl, false);
+        double once = benchColdStart(createImpl, true);
+
+        std::cout<<(boost::format("  %-10s default flow %10.0f usec, --once %10.0f usec")
+                    % backendName
+                    % defaultFlow
+                    % once).str()<<std::endl;
+    }
+    catch(const std::exception& e){
+        std::cout<<(boost::format("  %-10s skipped: %s") % backendName % e.what()).str()<<std::endl;
+    }
+}
+
+////////////////////////////////////////////////////////////
+///////            D-Bus traffic                  //////////
+////////////////////////////////////////////////////////////
+
+struct DbusMessageCount
+{
+    std::atomic<uint64_t> sent;
+    std::atomic<uint64_t> received;
+};
+
+/**< Runs on the GDBus worker thread for every message of the connection */
+GDBusMessage* countDbusMessage(GDBusConnection*, GDBusMessage* message, gboolean incoming, gpointer data)
+{
+    DbusMessageCount* count = static_cast<DbusMessageCount*>(data);
+    ++(incoming? count->received : count->sent);
+
+    return message;
+}
+
+/**
+* Counts the messages the NetworkManager backend exchanges on the shared system bus connection
+* while it is created, per read of the device list and per reread of a single device.
+* Signals arriving meanwhile are counted as received, so run it on an otherwise quiet host
+*/
+void reportDbusTraffic()
+{
+    GError* error = nullptr;
+    GDBusConnection* connection = g_bus_get_sync(G_BUS_TYPE_SYSTEM, nullptr, &error);
+
+    if(connection == nullptr)
+    {
+        std::cout<<(boost::format("  skipped: %s") % (error != nullptr? error->message : "no system bus")).str()<<std::endl;
+        if(error != nullptr){
+            g_error_free(error);
+        }
+
+        return;
+    }
+
+    DbusMessageCount count;
+    count.sent = count.received = 0;
+    guint filter = g_dbus_connection_add_filter(connection, countDbusMessage, &count, nullptr);
+
+    auto report = [&count](const std::string& step, const double& runs)
+    {
+        std::cout<<(boost::format("  %-30s sent %6.1f, received %6.1f")
+                    % step
+                    % (count.sent / runs)
+                    % (count.received / runs)).str()<<std::endl;
+
+        count.sent = count.received = 0;
+    };
+
+    try
+    {
+        ImplPtr impl = InterfaceManager::createImpl(BACKEND_NETWORK_MANAGER);
+        report("create and subscribe", 1);
+
+        for(uint i = 0; i < BENCH_DBUS_RUNS; ++i){
+            impl->updateDevices();
+        }
+
+        InterfaceInfoStorage interfaces = impl->getInterfacesData();
+        report((boost::format("device list of %d devices") % interfaces.size()).str(), BENCH_DBUS_RUNS);
+
+        for(auto& interface : interfaces){
+            impl->updateDevice(interface.first);
+        }
+
+        report("single device reread", std::max<size_t>(interfaces.size(), 1));
+    }
+    catch(const std::exception& e){
+        std::cout<<(boost::format("  skipped: %s") % e.what()).str()<<std::endl;
+    }
+
+    g_dbus_connection_remove_filter(connection, filter);
+    g_object_unref(connection);
+}
+
+int main()
+{
+    std::cout<<(boost::format("Thread scaling, %d updates over %d interfaces")
+                % BENCH_EVENT_COUNT
+                % BENCH_INTERFACE_COUNT).str()<<std::endl;
+
+    for(uint threadCount : {1, 2, 4, 8})
+    {
+        size_t orderViolations = 0;
+        double rate = benchThreadScaling(threadCount, orderViolations);
+
+        std::cout<<(boost::format("  threads %2d: %10.0f updates/s, order violations %d")
+                    % threadCount
+                    % rate
+                    % orderViolations).str()<<std::endl;
+    }
+
+    std::cout<<(boost::format("Per-update overhead, %d updates on a single thread") % BENCH_EVENT_COUNT).str()<<std::endl;
+    std::cout<<(boost::format("  InterfaceManager                       %8.1f nsec") % benchRuntimeManager()).str()<<std::endl;
+    std::cout<<(boost::format("  BasicInterfaceManager, StrandDispatch  %8.1f nsec")
+                % benchBasicManager<StrandDispatch>()).str()<<std::endl;
+    std::cout<<(boost::format("  BasicInterfaceManager, PooledDispatch  %8.1f nsec")
+                % benchBasicManager<PooledDispatch>()).str()<<std::endl;
+    std::cout<<(boost::format("  BasicInterfaceManager, DirectDispatch  %8.1f nsec")
+                % benchBasicManager<DirectDispatch>()).str()<<std::endl;
+
+    std::string sysfsRoot = makeSysfsTree(BENCH_SYSFS_INTERFACES);
+    std::pair<double, double> sysfsScan = benchSysfsScan(sysfsRoot + "/net");
+    system(("rm -rf " + sysfsRoot).c_str());
+
+    std::cout<<(boost::format("sysfs scan of %d interfaces") % BENCH_SYSFS_INTERFACES).str()<<std::endl;
+    std::cout<<(boost::format("  first scan %10.0f usec, unchanged scan %10.0f usec")
+                % sysfsScan.first
+                % sysfsScan.second).str()<<std::endl;
+
+    std::pair<double, double> hostScan = benchSysfsScan(SYSFS_NET_PATH);
+    std::cout<<(boost::format("  %s: first scan %6.0f usec, unchanged scan %6.0f usec")
+                % SYSFS_NET_PATH
+                % hostScan.first
+                % hostScan.second).str()<<std::endl;
+
+    std::cout<<(boost::format("Cold start until the first interface list, %d runs") % BENCH_COLD_START_RUNS).str()<<std::endl;
+
+    reportColdStart("synthetic", [](){ return ImplPtr(new SyntheticImpl(0, BENCH_INTERFACE_COUNT)); });
+    reportColdStart(BACKEND_NETWORK_MANAGER, [](){ return InterfaceManager::createImpl(BACKEND_NETWORK_MANAGER); });
+    reportColdStart(BACKEND_SYSFS, [](){ return InterfaceManager::createImpl(BACKEND_SYSFS); });
+
+    std::cout<<"D-Bus messages of the NetworkManager backend"<<std::endl;
+    reportDbusTraffic();
+
+    return 0;
+}
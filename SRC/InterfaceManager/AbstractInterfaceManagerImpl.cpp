@@ -4,23 +4,122 @@
 ///////         AbstractInterfaceManagerImpl      //////////
 ////////////////////////////////////////////////////////////
 
-AbstractInterfaceManagerImpl::AbstractInterfaceManagerImpl()
+AbstractInterfaceManagerImpl::AbstractInterfaceManagerImpl() :
+    mListener(nullptr),
+    mSequence(0),
+    mGeneration(0)
 {
 
 }
 
-const InterfaceInfoStorage& AbstractInterfaceManagerImpl::getInterfacesData()
+InterfaceInfoStorage AbstractInterfaceManagerImpl::getInterfacesData()
 {
     unique_lock lock(mMutex);
     return mInterfaces;
 }
 
+InterfaceInfoStorage AbstractInterfaceManagerImpl::getInterfacesData(uint64_t& sequence)
+{
+    unique_lock lock(mMutex);
+
+    sequence = mSequence;
+    return mInterfaces;
+}
+
+bool AbstractInterfaceManagerImpl::getInterfaceInfo(const std::string& deviceId, InterfaceInfo& info)
+{
+    unique_lock lock(mMutex);
+
+    auto stored = mInterfaces.find(deviceId);
+    if(stored == mInterfaces.end()){
+        return false;
+    }
+
+    info = stored->second;
+    return true;
+}
+
+uint64_t AbstractInterfaceManagerImpl::getSequence()
+{
+    unique_lock lock(mMutex);
+    return mSequence;
+}
+
+void AbstractInterfaceManagerImpl::stampEntry(InterfaceInfo& info)
+{
+    info.generation = ++mGeneration;
+}
+
+void AbstractInterfaceManagerImpl::stampUpdate(InterfaceInfo& info, const bool& action)
+{
+    if(action){
+        stampEntry(info);
+    }
+
+    info.sequence = ++mSequence;
+}
+
+void AbstractInterfaceManagerImpl::skipUpdate(const std::string& deviceId)
+{
+    /**< The gap tells consumers an update is missing, the request lets the manager reread the device */
+    reportResyncRequest(deviceId, ++mSequence);
+}
+
+void AbstractInterfaceManagerImpl::setListener(ImplListener* listener)
+{
+    unique_lock lock(mMutex);
+    mListener = listener;
+}
+
+void AbstractInterfaceManagerImpl::reportUpdate(const InterfaceInfo& info, const bool& action)
+{
+    if(mListener != nullptr){
+        mListener->onInterfaceUpdate(info, action);
+    }
+    else{
+        interfaceListUpdateSignal(info, action);
+    }
+}
+
+void AbstractInterfaceManagerImpl::reportUpdateFailed()
+{
+    if(mListener != nullptr){
+        mListener->onUpdateFailed();
+    }
+    else{
+        updateFailedSignal();
+    }
+}
+
+void AbstractInterfaceManagerImpl::reportResyncRequest(const std::string& deviceId, const uint64_t& skippedSequence)
+{
+    if(mListener != nullptr){
+        mListener->onResyncRequest(deviceId, skippedSequence);
+    }
+    else{
+        resyncRequestSignal(deviceId);
+    }
+}
+
 ////////////////////////////////////////////////////////////
 ///////             InterfaceInfo                 //////////
 ////////////////////////////////////////////////////////////
 
 InterfaceInfo::InterfaceInfo() :
-    type(IF_TYPE_UNKNOWN)
+    type(IF_TYPE_UNKNOWN),
+    sequence(0),
+    generation(0)
+{
+
+}
+
+////////////////////////////////////////////////////////////
+///////            InterfaceDetails               //////////
+////////////////////////////////////////////////////////////
+
+InterfaceDetails::InterfaceDetails() :
+    mtu(0),
+    speedMbps(-1)
 {
 
 }
@@ -8,6 +8,8 @@
 */
 
 #include <map>
+#include <memory>
+#include <stdint.h>
 #include <string.h>
 #include <sstream>
 
@@ -16,12 +18,15 @@
 #include <boost/thread/mutex.hpp>
 
 struct InterfaceInfo;
+struct InterfaceDetails;
 
 typedef std::map<std::string, InterfaceInfo> InterfaceInfoStorage;
 typedef std::pair<std::string, InterfaceInfo> InterfaceInfoPair;
 typedef boost::signals2::signal<void (const InterfaceInfo& info, const bool& action)> updateSignal;
 typedef boost::signals2::signal<void ()> errorSignal;
+typedef boost::signals2::signal<void (const std::string& deviceId)> deviceSignal;
 typedef boost::unique_lock<boost::mutex> unique_lock;
+typedef std::shared_ptr<const InterfaceDetails> InterfaceDetailsPtr;
 
 // Platform - independent interface types
 enum InterfaceType
@@ -32,6 +37,26 @@ enum InterfaceType
     IF_TYPE_UNKNOWN
 };
 
+////////////////////////////////////////////////////////////
+///////             ImplListener                  //////////
+////////////////////////////////////////////////////////////
+
+/**
+* @class ImplListener
+* @brief Receives the reports of a backend by plain virtual calls, with the backend lock held.
+*  Managers owning a backend use it instead of the signals
+*/
+
+class ImplListener
+{
+public:
+    virtual ~ImplListener(){}
+
+    virtual void onInterfaceUpdate(const InterfaceInfo& info, const bool& action) = 0;
+    virtual void onUpdateFailed() = 0;
+    virtual void onResyncRequest(const std::string& deviceId, const uint64_t& skippedSequence) = 0;   /**< 0 if no sequence was skipped */
+};
+
 ////////////////////////////////////////////////////////////
 ///////       AbstractInterfaceManagerImpl        //////////
 ////////////////////////////////////////////////////////////
@@ -50,17 +75,50 @@ public:
 
       virtual void startListening() = 0; /**< Begin listening to system notifications */
       virtual void stopListening() = 0;  /**< Stop listening to system notifications */
+
+      /**< Called where startListening() is requested to run later on another thread. A stop is remembered
+           only while a start is prepared or running, so one coming before startListening() is not lost */
+      virtual void prepareListening() {}
       virtual void updateDevices() = 0;  /**< Directly updates devices data */
 
-      const InterfaceInfoStorage& getInterfacesData();
+      /**< Rereads a single device and reports it if it has appeared, changed or vanished.
+           A change is reported as a removal of the old info followed by an addition of the new one.
+           Returns false if the device could not be read and may be retried */
+      virtual bool updateDevice(const std::string& deviceId) = 0;
+
+      InterfaceInfoStorage getInterfacesData();  /**< A copy made under the lock, safe to call from any thread */
+      InterfaceInfoStorage getInterfacesData(uint64_t& sequence);  /**< Also the sequence of the last update the copy reflects */
+      bool getInterfaceInfo(const std::string& deviceId, InterfaceInfo& info);  /**< Returns false for unknown devices */
+      uint64_t getSequence();                    /**< The sequence number of the last reported update */
+
+      /**< Reports go to the listener instead of the signals while it is set. Set it before listening */
+      void setListener(ImplListener* listener);
+
+protected:
+     /**< The functions below expect mMutex to be locked */
+     void stampEntry(InterfaceInfo& info);                       /**< Gives a stored entry a new generation */
+     void stampUpdate(InterfaceInfo& info, const bool& action);  /**< Numbers an update, an addition also gets a new generation */
+     void skipUpdate(const std::string& deviceId);               /**< Accounts for an update that could not be read */
+
+     /**< Reports to the listener, if any, or through the signals */
+     void reportUpdate(const InterfaceInfo& info, const bool& action);
+     void reportUpdateFailed();
+     void reportResyncRequest(const std::string& deviceId, const uint64_t& skippedSequence = 0);
 
 protected:
      InterfaceInfoStorage mInterfaces;         /**< All gathered interface data is stored here */
      boost::mutex mMutex; 
 
+private:
+     ImplListener* mListener;
+     uint64_t mSequence;
+     uint64_t mGeneration;                     /**< Shared by all devices, so generations never repeat */
+
 public:
+      /**< Not emitted while a listener is set */
       updateSignal interfaceListUpdateSignal;  /**< Emitted if an interface is added or removed */
       errorSignal  updateFailedSignal;         /**< Emitted on update error */
+      deviceSignal resyncRequestSignal;        /**< Emitted with the lock held if an update of the device has been lost */
 };
 
 ////////////////////////////////////////////////////////////
@@ -74,11 +132,36 @@ public:
 
 struct InterfaceInfo
 {
+    std::string id;         /**< Platform-dependent device id (NM object path), the key in InterfaceInfoStorage */
     std::string name;
     std::string hwAddr;
     InterfaceType type;
+    uint64_t sequence;      /**< Of the update that reported the info, numbers all updates of a backend without gaps */
+    uint64_t generation;    /**< Grows with every addition or change of the device, removals carry the removed one.
+                                 Drawn from a counter of the backend, so it grows by more than one between updates */
+    InterfaceDetailsPtr details;    /**< Optional, only set by InterfaceManager::getInterfaceDetails() */
 
     InterfaceInfo();
 };
 
+////////////////////////////////////////////////////////////
+///////            InterfaceDetails               //////////
+////////////////////////////////////////////////////////////
+
+/**
+* @class InterfaceDetails
+* @brief Interface metadata that backends do not report, resolved on demand by InterfaceDetailsCache
+*/
+
+struct InterfaceDetails
+{
+    std::string driver;     /**< Empty for virtual devices */
+    uint32_t mtu;
+    int32_t speedMbps;      /**< -1 if unknown, e.g. while the link is down */
+    std::string parent;     /**< The lower device of a vlan */
+    std::string master;     /**< The bridge or bond the device is enslaved to */
+
+    InterfaceDetails();
+};
+
 #endif // ABSTRACTIMTERFACEMANAGERIMPL_H
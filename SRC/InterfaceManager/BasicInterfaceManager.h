@@ -0,0 +1,546 @@
+#ifndef BASICINTERFACEMANAGER_H
+#define BASICINTERFACEMANAGER_H
+
+/**
+* @file BasicInterfaceManager.h
+* @brief Contains the interface manager with the backend, the update handler and the dispatch
+*  policy fixed at compile time. A concrete backend is stored by value and its calls are not virtual
+*  as long as the backend class is final. The backend reports to the manager through ImplListener
+*  and updates reach the handler through the dispatch policy without signals, binders or type erasure.
+*  With DirectDispatch an update costs a virtual call plus an inlined handler call.
+*
+*  InterfaceManager wraps BasicInterfaceManager<AbstractInterfaceManagerImpl, ...>: the backend is
+*  chosen at runtime and updates are delivered through signals to any number of consumers.
+*
+*  A handler provides:
+*   void onInterfaceUpdate(const InterfaceInfo& info, const bool& action);
+*   void onUpdateFailed();
+*  or, with PooledDispatch, void onInterfaceEvent(const InterfaceEvent& event) instead of the first one
+*/
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "DispatchPolicies.h"
+#include "TimerWheel.h"
+#include "InterfaceHistory.h"
+#include "InterfaceDetailsCache.h"
+#include "Tracer.h"
+
+#define IFMANAGER_MAX_BACKOFF_MSEC      60000   /**< Upper limit of the refresh period of a failing device */
+#define IFMANAGER_RESYNC_DELAY_MSEC     100     /**< Before retrying a failed resync, doubled on every failure */
+#define IFMANAGER_RESYNC_ATTEMPTS       8
+
+typedef std::function<void (const InterfaceInfo& info, const bool& present)> ResyncCallback;
+typedef std::function<void (const InterfaceInfoStorage& interfaces)> InterfaceDetailsCallback;
+
+////////////////////////////////////////////////////////////
+///////             BackendStorage                //////////
+////////////////////////////////////////////////////////////
+
+/**
+* @class BackendStorage
+* @brief Concrete backends are stored by value, abstract ones are owned through a pointer.
+*  Either way the backend is not part of the const state of the manager
+*/
+
+template <class Backend, bool Abstract = std::is_abstract<Backend>::value>
+class BackendStorage
+{
+public:
+    template <class... BackendArgs>
+    BackendStorage(BackendArgs&&... backendArgs) :
+        mBackend(std::forward<BackendArgs>(backendArgs)...){}
+
+    Backend& get() const
+    {
+        return mBackend;
+    }
+
+private:
+    mutable Backend mBackend;
+};
+
+template <class Backend>
+class BackendStorage<Backend, true>
+{
+public:
+    BackendStorage(std::unique_ptr<Backend> backend) :
+        mBackend(std::move(backend)){}
+
+    Backend& get() const
+    {
+        return *mBackend;
+    }
+
+private:
+    std::unique_ptr<Backend> mBackend;
+};
+
+////////////////////////////////////////////////////////////
+///////          BasicInterfaceManager            //////////
+////////////////////////////////////////////////////////////
+
+/**
+* @class BasicInterfaceManager
+* @brief The backend thread is only started by the first startListening(), so one-shot
+*  users calling updateDevices() and getInterfaceData() do not pay for it.
+*  Listening may be stopped and started again on the same manager.
+*  Refreshes and resyncs are timed on the event loop by a single timer wheel, the devices are
+*  reread on a worker thread started by the first reread, as a backend read may block.
+*  The update history is off until setHistoryLimit() is called
+*/
+
+template <class Backend, class Handler, class Dispatch = StrandDispatch>
+class BasicInterfaceManager : private ImplListener
+{
+public:
+    typedef Backend BackendType;
+    typedef InterfaceInfoStorage StorageType;
+
+    template <class... BackendArgs>
+    BasicInterfaceManager(boost::asio::io_service& io, Handler& handler, BackendArgs&&... backendArgs) :
+        mBackend(std::forward<BackendArgs>(backendArgs)...),
+        mHandler(handler),
+        mEventLoop(io),
+        mDispatch(io),
+        mWork(new boost::asio::io_service::work(mImplService)),
+        mRereadWork(new boost::asio::io_service::work(mRereadService)),
+        mTimerWheel(io),
+        mRefreshGeneration(0),
+        mLastSequence(mBackend.get().getSequence()),
+        mLostUpdates(0),
+        mSkippedUpdates(0),
+        mHistoryEnabled(false),
+        mPaused(false)
+    {
+        mBackend.get().setListener(this);
+    }
+
+    ~BasicInterfaceManager()
+    {
+        mTimerWheel.clear();
+
+        stopListening();
+        mImplService.stop();
+        mRereadService.stop();
+        mThreadGroop.join_all();
+
+        mBackend.get().setListener(nullptr);
+    }
+
+    void startListening()
+    {
+        std::call_once(mThreadStarted, [this](){ mThreadGroop.create_thread(boost::bind(&boost::asio::io_service::run, &mImplService)); });
+        mBackend.get().prepareListening();
+        mImplService.dispatch(boost::bind(&Backend::startListening, &mBackend.get()));
+    }
+
+    void stopListening()
+    {
+        mBackend.get().stopListening();
+    }
+
+    void updateDevices()
+    {
+        mBackend.get().updateDevices();
+    }
+
+    /**< The backend keeps listening and the table stays up to date while paused, but no updates are delivered.
+         resume() delivers a single diff instead: the removal of every interface that is gone or has changed
+         since pause() and the addition of every new or changed one, with their current generations */
+    void pause()
+    {
+        unique_lock lock(mPauseMutex);
+        mPaused = true;
+    }
+
+    void resume()
+    {
+        unique_lock lock(mPauseMutex);
+
+        if(!mPaused){
+            return;
+        }
+
+        /**< Dispatched under the lock, so updates arriving meanwhile are delivered after the diff */
+        for(auto& device : mPausedChanges)
+        {
+            const PausedChange& change = device.second;
+
+            bool changed = change.presentBefore != change.presentAfter ||
+                           (change.presentBefore && (change.before.generation != change.after.generation ||
+                                                     change.before.name != change.after.name ||
+                                                     change.before.hwAddr != change.after.hwAddr ||
+                                                     change.before.type != change.after.type));
+            if(!changed){
+                continue;
+            }
+
+            if(change.presentBefore){
+                mDispatch.dispatchUpdate(mHandler, change.before, false);
+            }
+
+            if(change.presentAfter){
+                mDispatch.dispatchUpdate(mHandler, change.after, true);
+            }
+        }
+
+        mPausedChanges.clear();
+        mPaused = false;
+    }
+
+    bool isPaused() const
+    {
+        return mPaused;
+    }
+
+    StorageType getInterfaceData() const
+    {
+        return mBackend.get().getInterfacesData();
+    }
+
+    StorageType getInterfaceData(uint64_t& sequence) const   /**< Updates up to sequence are reflected in the copy */
+    {
+        return mBackend.get().getInterfacesData(sequence);
+    }
+
+    /**< Periodically rereads a device (see InterfaceInfo::id) on the reread worker, 0 disables refreshing.
+         Failing reads are retried with an exponential backoff */
+    void setRefreshPeriod(const std::string& deviceId, const uint32_t& periodMsec)
+    {
+        unique_lock lock(mRefreshMutex);
+
+        auto job = mRefreshJobs.find(deviceId);
+        if(job != mRefreshJobs.end())
+        {
+            mTimerWheel.cancel(job->second.timer);
+            mRefreshJobs.erase(job);
+        }
+
+        if(periodMsec)
+        {
+            RefreshJob& newJob = mRefreshJobs[deviceId];
+            newJob.periodMsec = periodMsec;
+            newJob.failures = 0;
+            newJob.generation = ++mRefreshGeneration;
+            newJob.timer = mTimerWheel.schedule(periodMsec, boost::bind(&BasicInterfaceManager::onRefreshTimeout, this,
+                                                                        deviceId, newJob.generation));
+        }
+    }
+
+    /**< Rereads a single device on the reread worker, e.g. after a consumer has found a gap in its generations.
+         Changes are reported as usual, then the callback, if any, gets the current info through the device strand.
+         A device that cannot be read is retried with a backoff, the handler gets onUpdateFailed() if all attempts fail.
+         Backends request resyncs of devices whose updates they have lost on their own */
+    void resyncDevice(const std::string& deviceId, const ResyncCallback& callback = ResyncCallback())
+    {
+        /**< Backends request resyncs with their lock held, so the device is never reread right away */
+        mTimerWheel.schedule(0, boost::bind(&BasicInterfaceManager::onResyncTimeout, this, deviceId, callback, 0));
+    }
+
+    uint64_t getLostUpdateCount() const       /**< Gaps in the backend update sequence */
+    {
+        return mLostUpdates;
+    }
+
+    uint64_t getSkippedUpdateCount() const    /**< Updates the backend could not read and requested a resync for, not counted as lost */
+    {
+        return mSkippedUpdates;
+    }
+
+    HistoryEvents getHistory(const HistoryTime& from, const HistoryTime& to) const
+    {
+        return mHistory.getRange(from, to);
+    }
+
+    HistoryEvents getInterfaceHistory(const std::string& deviceId,
+                                      const HistoryTime& from = boost::posix_time::min_date_time,
+                                      const HistoryTime& to = boost::posix_time::max_date_time) const
+    {
+        return mHistory.getInterfaceHistory(deviceId, from, to);
+    }
+
+    void setHistoryLimit(const size_t& maxBytes)   /**< 0 stops recording and forgets the history */
+    {
+        mHistory.setMaxBytes(maxBytes);
+        mHistoryEnabled = maxBytes != 0;
+    }
+
+    /**< Driver, MTU, speed, vlan parent and master are read on a worker the first time they are asked for
+         and cached until the device is updated. Backend updates are never delayed by them.
+         The callback gets the known devices among the passed ones with InterfaceInfo::details set, on the event loop */
+    void getInterfaceDetails(const std::vector<std::string>& deviceIds, const InterfaceDetailsCallback& callback)
+    {
+        std::vector<InterfaceInfo> interfaces;
+        interfaces.reserve(deviceIds.size());
+
+        for(auto& deviceId : deviceIds)
+        {
+            InterfaceInfo info;
+            if(mBackend.get().getInterfaceInfo(deviceId, info)){
+                interfaces.push_back(info);
+            }
+        }
+
+        /**< The worker may outlive the call, but not the event loop */
+        boost::asio::io_service& eventLoop = mEventLoop;
+
+        mDetails.fetch(interfaces, [&eventLoop, interfaces, callback](const std::vector<InterfaceDetailsPtr>& details)
+        {
+            InterfaceInfoStorage result;
+            for(size_t i = 0; i < interfaces.size(); ++i)
+            {
+                InterfaceInfo& info = result[interfaces[i].id] = interfaces[i];
+                info.details = details[i];
+            }
+
+            eventLoop.post([callback, result](){ callback(result); });
+        });
+    }
+
+    InterfaceDetailsPtr getInterfaceDetails(const std::string& deviceId)   /**< Blocks until resolved, nullptr if unknown */
+    {
+        InterfaceInfo info;
+        if(!mBackend.get().getInterfaceInfo(deviceId, info)){
+            return InterfaceDetailsPtr();
+        }
+
+        std::promise<InterfaceDetailsPtr> details;
+        mDetails.fetch(std::vector<InterfaceInfo>(1, info), [&details](const std::vector<InterfaceDetailsPtr>& resolved)
+        {
+            details.set_value(resolved.front());
+        });
+
+        return details.get_future().get();
+    }
+
+    Backend& getBackend()
+    {
+        return mBackend.get();
+    }
+
+    Dispatch& getDispatch()
+    {
+        return mDispatch;
+    }
+
+private:
+    struct PausedChange
+    {
+        InterfaceInfo before;   /**< As reported by the first update after pause() */
+        bool presentBefore;
+        InterfaceInfo after;    /**< As reported by the last one */
+        bool presentAfter;
+    };
+
+    struct RefreshJob
+    {
+        uint32_t periodMsec;
+        uint32_t failures;
+        uint64_t generation;    /**< Changes on every setRefreshPeriod() to ignore outdated timeouts */
+        TimerId timer;
+    };
+
+private:
+    BasicInterfaceManager(const BasicInterfaceManager&);
+    BasicInterfaceManager& operator=(const BasicInterfaceManager&);
+
+    /**< ImplListener, called by the backend with its lock held */
+    void onInterfaceUpdate(const InterfaceInfo& info, const bool& action) override
+    {
+        checkSequence(info.sequence);
+
+        /**< Compacting the history takes a while, so it is left to the event loop */
+        if(mHistoryEnabled && mHistory.record(info, action)){
+            mEventLoop.post(boost::bind(&InterfaceHistory::compact, &mHistory));
+        }
+
+        mDetails.invalidate(info.id);
+
+        if(mPaused && deferUpdate(info, action)){
+            return;
+        }
+
+        mDispatch.dispatchUpdate(mHandler, info, action);
+    }
+
+    void onUpdateFailed() override
+    {
+        Handler& handler = mHandler;
+        mDispatch.dispatch(std::string(), [&handler](){ handler.onUpdateFailed(); });
+    }
+
+    void onResyncRequest(const std::string& deviceId, const uint64_t& skippedSequence) override
+    {
+        if(skippedSequence)
+        {
+            checkSequence(skippedSequence);
+            ++mSkippedUpdates;
+        }
+
+        resyncDevice(deviceId);
+    }
+
+    void checkSequence(const uint64_t& sequence)
+    {
+        /**< Unnumbered updates of custom backends are not checked */
+        if(!sequence){
+            return;
+        }
+
+        uint64_t lastSequence = mLastSequence.exchange(sequence);
+        if(sequence > lastSequence + 1){
+            mLostUpdates += sequence - lastSequence - 1;
+        }
+    }
+
+    bool deferUpdate(const InterfaceInfo& info, const bool& action)   /**< Returns false if not paused */
+    {
+        unique_lock lock(mPauseMutex);
+
+        if(!mPaused){
+            return false;
+        }
+
+        /**< A device is updated by a removal and an addition, so the first update tells whether it was present */
+        auto inserted = mPausedChanges.insert(std::make_pair(info.id, PausedChange()));
+        PausedChange& change = inserted.first->second;
+
+        if(inserted.second)
+        {
+            change.before = info;
+            change.presentBefore = !action;
+        }
+
+        change.after = info;
+        change.presentAfter = action;
+
+        return true;
+    }
+
+    void onRefreshTimeout(const std::string& deviceId, const uint64_t& generation)
+    {
+        {
+            unique_lock lock(mRefreshMutex);
+
+            auto job = mRefreshJobs.find(deviceId);
+            if(job == mRefreshJobs.end() || job->second.generation != generation){
+                return;
+            }
+        }
+
+        postReread(boost::bind(&BasicInterfaceManager::refreshDevice, this, deviceId, generation));
+    }
+
+    void refreshDevice(const std::string& deviceId, const uint64_t& generation)   /**< Runs on the reread worker */
+    {
+        bool updated = mBackend.get().updateDevice(deviceId);
+
+        unique_lock lock(mRefreshMutex);
+
+        auto job = mRefreshJobs.find(deviceId);
+        if(job == mRefreshJobs.end() || job->second.generation != generation){
+            return;
+        }
+
+        RefreshJob& refreshJob = job->second;
+        refreshJob.failures = updated? 0 : refreshJob.failures + 1;
+
+        uint64_t delay = refreshJob.periodMsec;
+        for(uint32_t i = 0; i < refreshJob.failures && delay < IFMANAGER_MAX_BACKOFF_MSEC; ++i){
+            delay *= 2;
+        }
+
+        delay = std::min<uint64_t>(delay, std::max<uint32_t>(IFMANAGER_MAX_BACKOFF_MSEC, refreshJob.periodMsec));
+        refreshJob.timer = mTimerWheel.schedule(delay, boost::bind(&BasicInterfaceManager::onRefreshTimeout, this,
+                                                                   deviceId, generation));
+    }
+
+    void onResyncTimeout(const std::string& deviceId, const ResyncCallback& callback, const uint32_t& failures)
+    {
+        postReread(boost::bind(&BasicInterfaceManager::resyncNow, this, deviceId, callback, failures));
+    }
+
+    void resyncNow(const std::string& deviceId, const ResyncCallback& callback, const uint32_t& failures)   /**< Runs on the reread worker */
+    {
+        TRACE_SPAN("BasicInterfaceManager::resyncNow");
+
+        if(!mBackend.get().updateDevice(deviceId))
+        {
+            if(failures + 1 >= IFMANAGER_RESYNC_ATTEMPTS)
+            {
+                onUpdateFailed();
+                return;
+            }
+
+            uint64_t delay = std::min<uint64_t>(static_cast<uint64_t>(IFMANAGER_RESYNC_DELAY_MSEC) << failures,
+                                                IFMANAGER_MAX_BACKOFF_MSEC);
+            mTimerWheel.schedule(delay, boost::bind(&BasicInterfaceManager::onResyncTimeout, this, deviceId, callback, failures + 1));
+            return;
+        }
+
+        if(callback)
+        {
+            InterfaceInfo info;
+            info.id = deviceId;
+            bool present = mBackend.get().getInterfaceInfo(deviceId, info);
+
+            /**< After the updates the reread has reported, as they went through the same strand */
+            mDispatch.dispatch(deviceId, [callback, info, present](){ callback(info, present); });
+        }
+    }
+
+    /**< Backend reads may block, e.g. on D-Bus round trips, so they are kept off the event loop.
+         Results reach the handler through the dispatch policy as usual */
+    template <class Function>
+    void postReread(const Function& reread)
+    {
+        std::call_once(mRereadThreadStarted, [this](){ mThreadGroop.create_thread(boost::bind(&boost::asio::io_service::run, &mRereadService)); });
+
+        /**< The reread continues the job of the event loop, so the loop does not run out of work meanwhile */
+        boost::asio::io_service::work work(mEventLoop);
+        mRereadService.post([reread, work](){ reread(); });
+    }
+
+private:
+    BackendStorage<Backend> mBackend;
+    Handler& mHandler;
+    boost::asio::io_service& mEventLoop;
+    Dispatch mDispatch;
+    boost::asio::io_service mImplService;
+    boost::thread_group mThreadGroop;
+    std::once_flag mThreadStarted;
+    std::unique_ptr<boost::asio::io_service::work> mWork;
+    boost::asio::io_service mRereadService;    /**< mImplService is taken by the backend loop while listening */
+    std::once_flag mRereadThreadStarted;
+    std::unique_ptr<boost::asio::io_service::work> mRereadWork;
+
+    TimerWheel mTimerWheel;                    /**< Drives all per-device jobs with a single timer */
+    std::map<std::string, RefreshJob> mRefreshJobs;
+    uint64_t mRefreshGeneration;
+    boost::mutex mRefreshMutex;
+
+    std::atomic<uint64_t> mLastSequence;       /**< Backends emit under their lock, so updates arrive in sequence order */
+    std::atomic<uint64_t> mLostUpdates;
+    std::atomic<uint64_t> mSkippedUpdates;
+
+    InterfaceHistory mHistory;
+    std::atomic<bool> mHistoryEnabled;
+    InterfaceDetailsCache mDetails;
+
+    std::atomic<bool> mPaused;
+    std::map<std::string, PausedChange> mPausedChanges;
+    boost::mutex mPauseMutex;
+};
+
+#endif // BASICINTERFACEMANAGER_H
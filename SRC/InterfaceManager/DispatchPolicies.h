@@ -0,0 +1,245 @@
+#ifndef DISPATCHPOLICIES_H
+#define DISPATCHPOLICIES_H
+
+/**
+* @file DispatchPolicies.h
+* @brief Contains policies deciding where interface updates are handled.
+*  A policy is constructed with the consumer event loop and provides
+*   template <class Function> void dispatch(const std::string& deviceId, Function&& function)
+*   template <class Handler> void dispatchUpdate(Handler& handler, const InterfaceInfo& info, const bool& action)
+*  the latter calls handler.onInterfaceUpdate(info, action) and lets direct dispatching skip copying the info.
+*  PooledDispatch calls handler.onInterfaceEvent(const InterfaceEvent& event) instead
+*/
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "AbstractInterfaceManagerImpl.h"
+#include "EventPool.h"
+
+#define IFMANAGER_STRAND_COUNT          64      /**< Updates are spread over strands by device id */
+
+typedef std::unique_ptr<boost::asio::io_service::strand> StrandPtr;
+
+////////////////////////////////////////////////////////////
+///////             StrandDispatch                //////////
+////////////////////////////////////////////////////////////
+
+/**
+* @class StrandDispatch
+* @brief Posts updates to the event loop. Updates of one device go through the same strand
+*  and stay ordered, updates of different devices may be handled in parallel
+*/
+
+class StrandDispatch
+{
+public:
+    StrandDispatch(boost::asio::io_service& io, const size_t& strandCount = IFMANAGER_STRAND_COUNT)
+    {
+        for(size_t i = 0; i < strandCount; ++i){
+            mStrands.push_back(StrandPtr(new boost::asio::io_service::strand(io)));
+        }
+    }
+
+    template <class Function>
+    void dispatch(const std::string& deviceId, Function&& function)
+    {
+        getStrand(deviceId).post(std::forward<Function>(function));
+    }
+
+    template <class Handler>
+    void dispatchUpdate(Handler& handler, const InterfaceInfo& info, const bool& action)
+    {
+        bool added = action;
+        getStrand(info.id).post([&handler, info, added](){ handler.onInterfaceUpdate(info, added); });
+    }
+
+    boost::asio::io_service::strand& getStrand(const std::string& deviceId)
+    {
+        return *mStrands[std::hash<std::string>()(deviceId) % mStrands.size()];
+    }
+
+private:
+    std::vector<StrandPtr> mStrands;
+};
+
+////////////////////////////////////////////////////////////
+///////             DirectDispatch                //////////
+////////////////////////////////////////////////////////////
+
+/**
+* @class DirectDispatch
+* @brief Handles updates right on the backend thread. The cheapest option
+*  for handlers that are thread-safe and do not block
+*/
+
+class DirectDispatch
+{
+public:
+    DirectDispatch(boost::asio::io_service&){}
+
+    template <class Function>
+    void dispatch(const std::string&, Function&& function)
+    {
+        function();
+    }
+
+    template <class Handler>
+    void dispatchUpdate(Handler& handler, const InterfaceInfo& info, const bool& action)
+    {
+        handler.onInterfaceUpdate(info, action);
+    }
+};
+
+////////////////////////////////////////////////////////////
+///////          PooledHandlerAllocator           //////////
+////////////////////////////////////////////////////////////
+
+/**
+* @class PooledHandlerAllocator
+* @brief Hands out the handler storage of one pooled record. asio rebinds it
+*  to the operation type and allocates a single operation at a time
+*/
+
+template <class T>
+class PooledHandlerAllocator
+{
+public:
+    typedef T value_type;
+
+    PooledHandlerAllocator(EventPool& pool, const EventHandle& handle) :
+        mPool(&pool), mHandle(handle){}
+
+    template <class U>
+    PooledHandlerAllocator(const PooledHandlerAllocator<U>& other) :
+        mPool(other.mPool), mHandle(other.mHandle){}
+
+    T* allocate(std::size_t count)
+    {
+        return static_cast<T*>(mPool->allocateHandler(mHandle, count * sizeof(T)));
+    }
+
+    void deallocate(T* pointer, std::size_t)
+    {
+        mPool->deallocateHandler(mHandle, pointer);
+    }
+
+    template <class U>
+    bool operator==(const PooledHandlerAllocator<U>& other) const
+    {
+        return mPool == other.mPool && mHandle == other.mHandle;
+    }
+
+    template <class U>
+    bool operator!=(const PooledHandlerAllocator<U>& other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    template <class U> friend class PooledHandlerAllocator;
+
+    EventPool* mPool;
+    EventHandle mHandle;
+};
+
+////////////////////////////////////////////////////////////
+///////            PooledEventHandler             //////////
+////////////////////////////////////////////////////////////
+
+/**
+* @class PooledEventHandler
+* @brief Delivers a pooled record to the handler and releases it. The associated
+*  allocator places the operation wrapping this handler into the record's own storage
+*/
+
+template <class Handler>
+class PooledEventHandler
+{
+public:
+    typedef PooledHandlerAllocator<void> allocator_type;
+
+    PooledEventHandler(EventPool& pool, Handler& handler, const EventHandle& handle) :
+        mPool(&pool), mHandler(&handler), mHandle(handle){}
+
+    void operator()()
+    {
+        mHandler->onInterfaceEvent(mPool->get(mHandle));
+        mPool->release(mHandle);
+    }
+
+    allocator_type get_allocator() const
+    {
+        return allocator_type(*mPool, mHandle);
+    }
+
+private:
+    EventPool* mPool;
+    Handler* mHandler;
+    EventHandle mHandle;
+};
+
+////////////////////////////////////////////////////////////
+///////             PooledDispatch                //////////
+////////////////////////////////////////////////////////////
+
+/**
+* @class PooledDispatch
+* @brief Keeps the StrandDispatch ordering, but copies each update into a pooled record
+*  and passes it by handle. Once the pool is allocated an update costs no heap allocation.
+*  If the pool is exhausted the update is still delivered from a heap record, which is counted
+*/
+
+class PooledDispatch
+{
+public:
+    PooledDispatch(boost::asio::io_service& io,
+                   const size_t& poolCapacity = EVENT_POOL_DEFAULT_CAPACITY,
+                   const size_t& strandCount = IFMANAGER_STRAND_COUNT) :
+        mStrands(io, strandCount), mPool(poolCapacity), mOverflowCount(0){}
+
+    template <class Function>
+    void dispatch(const std::string& deviceId, Function&& function)
+    {
+        mStrands.dispatch(deviceId, std::forward<Function>(function));
+    }
+
+    template <class Handler>
+    void dispatchUpdate(Handler& handler, const InterfaceInfo& info, const bool& action)
+    {
+        EventHandle handle = mPool.acquire();
+        if(handle == EVENT_HANDLE_INVALID)
+        {
+            ++mOverflowCount;
+
+            std::shared_ptr<InterfaceEvent> event(new InterfaceEvent());
+            event->assign(info, action);
+            mStrands.getStrand(info.id).post([&handler, event](){ handler.onInterfaceEvent(*event); });
+            return;
+        }
+
+        mPool.get(handle).assign(info, action);
+        mStrands.getStrand(info.id).post(PooledEventHandler<Handler>(mPool, handler, handle));
+    }
+
+    EventPool& getPool()
+    {
+        return mPool;
+    }
+
+    size_t getOverflowCount() const
+    {
+        return mOverflowCount;
+    }
+
+private:
+    StrandDispatch mStrands;
+    EventPool mPool;
+    std::atomic<size_t> mOverflowCount;
+};
+
+#endif // DISPATCHPOLICIES_H
@@ -0,0 +1,121 @@
+#include "EventPool.h"
+
+#include <algorithm>
+
+namespace
+{
+    /**< Copies as much as fits, returns false if the source was cut */
+    bool copyInline(char* destination, const size_t& size, const std::string& source)
+    {
+        size_t length = std::min(source.size(), size - 1);
+        memcpy(destination, source.data(), length);
+        destination[length] = '\0';
+
+        return length == source.size();
+    }
+}
+
+////////////////////////////////////////////////////////////
+///////             InterfaceEvent                //////////
+////////////////////////////////////////////////////////////
+
+InterfaceEvent::InterfaceEvent() :
+    type(IF_TYPE_UNKNOWN),
+    sequence(0),
+    generation(0),
+    action(false),
+    truncated(false)
+{
+    id[0] = name[0] = hwAddr[0] = '\0';
+}
+
+void InterfaceEvent::assign(const InterfaceInfo& info, const bool& added)
+{
+    truncated = !copyInline(id, sizeof(id), info.id);
+    truncated = !copyInline(name, sizeof(name), info.name) || truncated;
+    truncated = !copyInline(hwAddr, sizeof(hwAddr), info.hwAddr) || truncated;
+    type = info.type;
+    sequence = info.sequence;
+    generation = info.generation;
+    action = added;
+}
+
+InterfaceInfo InterfaceEvent::toInfo() const
+{
+    InterfaceInfo info;
+    info.id = id;
+    info.name = name;
+    info.hwAddr = hwAddr;
+    info.type = type;
+    info.sequence = sequence;
+    info.generation = generation;
+
+    return info;
+}
+
+////////////////////////////////////////////////////////////
+///////               EventPool                   //////////
+////////////////////////////////////////////////////////////
+
+EventPool::EventPool(const size_t& capacity) :
+    mRecords(capacity)
+{
+    mFree.reserve(capacity);
+
+    /**< Lower handles are handed out first */
+    for(size_t i = capacity; i > 0; --i){
+        mFree.push_back(static_cast<EventHandle>(i - 1));
+    }
+}
+
+EventHandle EventPool::acquire()
+{
+    boost::mutex::scoped_lock lock(mMutex);
+
+    if(mFree.empty()){
+        return EVENT_HANDLE_INVALID;
+    }
+
+    EventHandle handle = mFree.back();
+    mFree.pop_back();
+
+    return handle;
+}
+
+void EventPool::release(const EventHandle& handle)
+{
+    boost::mutex::scoped_lock lock(mMutex);
+    mFree.push_back(handle);
+}
+
+InterfaceEvent& EventPool::get(const EventHandle& handle)
+{
+    return mRecords[handle].event;
+}
+
+void* EventPool::allocateHandler(const EventHandle& handle, const size_t& size)
+{
+    if(size <= EVENT_HANDLER_STORAGE_SIZE){
+        return mRecords[handle].handlerStorage;
+    }
+
+    return ::operator new(size);
+}
+
+void EventPool::deallocateHandler(const EventHandle& handle, void* pointer)
+{
+    if(pointer != mRecords[handle].handlerStorage){
+        ::operator delete(pointer);
+    }
+}
+
+size_t EventPool::capacity() const
+{
+    return mRecords.size();
+}
+
+size_t EventPool::available() const
+{
+    boost::mutex::scoped_lock lock(mMutex);
+    return mFree.size();
+}
@@ -0,0 +1,99 @@
+#ifndef EVENTPOOL_H
+#define EVENTPOOL_H
+
+/**
+* @file EventPool.h
+* @brief Contains preallocated interface update records. A record keeps the device id,
+*  name and MAC inline and has room for the asio operation that delivers it, so an update
+*  handed over by handle costs no heap allocation once the pool is allocated
+*/
+
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+#include <boost/thread/mutex.hpp>
+
+#include "AbstractInterfaceManagerImpl.h"
+
+#define EVENT_POOL_DEFAULT_CAPACITY     1024
+#define EVENT_ID_SIZE                   128     /**< NM object paths are about 45 characters long */
+#define EVENT_NAME_SIZE                 32      /**< IFNAMSIZ is 16 */
+#define EVENT_HWADDR_SIZE               32      /**< Enough for an infiniband address */
+#define EVENT_HANDLER_STORAGE_SIZE      128     /**< Room for a posted asio operation */
+#define EVENT_HANDLE_INVALID            0xFFFFFFFF
+
+typedef uint32_t EventHandle;
+
+////////////////////////////////////////////////////////////
+///////             InterfaceEvent                //////////
+////////////////////////////////////////////////////////////
+
+/**
+* @class InterfaceEvent
+* @brief An interface update with fixed-capacity inline strings.
+*  Longer strings are cut and the record is marked as truncated
+*/
+
+struct InterfaceEvent
+{
+    char id[EVENT_ID_SIZE];
+    char name[EVENT_NAME_SIZE];
+    char hwAddr[EVENT_HWADDR_SIZE];
+    InterfaceType type;
+    uint64_t sequence;                          /**< As in InterfaceInfo, for gap detection by pooled consumers */
+    uint64_t generation;
+    bool action;                                /**< true if the interface was added */
+    bool truncated;
+
+    InterfaceEvent();
+
+    void assign(const InterfaceInfo& info, const bool& added);
+    InterfaceInfo toInfo() const;               /**< Allocates, for consumers that need InterfaceInfo */
+};
+
+////////////////////////////////////////////////////////////
+///////               EventPool                   //////////
+////////////////////////////////////////////////////////////
+
+/**
+* @class EventPool
+* @brief A fixed number of InterfaceEvent records handed out by handle.
+*  Records are acquired by the producer and released by the consumer, from any thread
+*/
+
+class EventPool
+{
+private:
+    struct Record
+    {
+        InterfaceEvent event;
+        alignas(std::max_align_t) unsigned char handlerStorage[EVENT_HANDLER_STORAGE_SIZE];
+    };
+
+public:
+    EventPool(const size_t& capacity = EVENT_POOL_DEFAULT_CAPACITY);
+
+    EventHandle acquire();                      /**< Returns EVENT_HANDLE_INVALID if the pool is exhausted */
+    void release(const EventHandle& handle);
+
+    InterfaceEvent& get(const EventHandle& handle);
+
+    /**< Memory for the operation delivering the record, falls back to the heap if the operation does not fit */
+    void* allocateHandler(const EventHandle& handle, const size_t& size);
+    void deallocateHandler(const EventHandle& handle, void* pointer);
+
+    size_t capacity() const;
+    size_t available() const;
+
+private:
+    EventPool(const EventPool&);
+    EventPool& operator=(const EventPool&);
+
+private:
+    std::vector<Record> mRecords;
+    std::vector<EventHandle> mFree;             /**< Reserved for all handles, so releasing never allocates */
+    mutable boost::mutex mMutex;
+};
+
+#endif // EVENTPOOL_H
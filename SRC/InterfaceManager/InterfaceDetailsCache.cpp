@@ -0,0 +1,242 @@
+#include "InterfaceDetailsCache.h"
+#include "Tracer.h"
+
+#include <algorithm>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+namespace
+{
+    /**< Reads a whole attribute without the trailing newline */
+    bool readValue(const std::string& path, char* buffer)
+    {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if(fd < 0){
+            return false;
+        }
+
+        ssize_t size = read(fd, buffer, SYSFS_ATTRIBUTE_SIZE - 1);
+        close(fd);
+
+        if(size < 0){
+            return false;
+        }
+
+        buffer[size] = '\0';
+        buffer[strcspn(buffer, "\n")] = '\0';
+        return true;
+    }
+
+    /**< The last component of a link target, empty if there is no link */
+    std::string readLinkName(const std::string& path)
+    {
+        char target[SYSFS_ATTRIBUTE_SIZE];
+
+        ssize_t size = readlink(path.c_str(), target, sizeof(target) - 1);
+        if(size < 0){
+            return std::string();
+        }
+
+        target[size] = '\0';
+        const char* name = strrchr(target, '/');
+
+        return name != nullptr? name + 1 : target;
+    }
+
+    std::string findLowerDevice(const std::string& path)
+    {
+        std::string lower;
+
+        DIR* dir = opendir(path.c_str());
+        if(dir == nullptr){
+            return lower;
+        }
+
+        while(dirent* entry = readdir(dir))
+        {
+            if(strncmp(entry->d_name, DETAILS_LOWER_PREFIX, strlen(DETAILS_LOWER_PREFIX)) == 0)
+            {
+                lower = entry->d_name + strlen(DETAILS_LOWER_PREFIX);
+                break;
+            }
+        }
+
+        closedir(dir);
+        return lower;
+    }
+}
+
+////////////////////////////////////////////////////////////
+///////          InterfaceDetailsCache            //////////
+////////////////////////////////////////////////////////////
+
+InterfaceDetailsCache::InterfaceDetailsCache(const std::string& path) :
+    mPath(path),
+    mDraining(false),
+    mWork(new boost::asio::io_service::work(mWorkerService))
+{
+
+}
+
+void InterfaceDetailsCache::fetch(const std::vector<InterfaceInfo>& interfaces, const DetailsCallback& callback)
+{
+    std::vector<InterfaceDetailsPtr> details;
+    details.reserve(interfaces.size());
+
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+
+        for(auto& info : interfaces)
+        {
+            auto cached = mDetails.find(info.id);
+            if(cached == mDetails.end()){
+                break;
+            }
+
+            details.push_back(cached->second);
+        }
+
+        if(details.size() != interfaces.size())
+        {
+            Request request;
+            request.interfaces = interfaces;
+            request.callback = callback;
+            mRequests.push_back(request);
+
+            /**< Later requests join the pass that has been posted already */
+            if(mRequests.size() > 1){
+                return;
+            }
+        }
+    }
+
+    if(details.size() == interfaces.size())
+    {
+        callback(details);
+        return;
+    }
+
+    std::call_once(mWorkerStarted, [this](){ mWorker = boost::thread(boost::bind(&boost::asio::io_service::run, &mWorkerService)); });
+    mWorkerService.post(boost::bind(&InterfaceDetailsCache::drain, this));
+}
+
+InterfaceDetailsPtr InterfaceDetailsCache::getCached(const std::string& deviceId) const
+{
+    boost::mutex::scoped_lock lock(mMutex);
+
+    auto cached = mDetails.find(deviceId);
+    return cached != mDetails.end()? cached->second : InterfaceDetailsPtr();
+}
+
+void InterfaceDetailsCache::invalidate(const std::string& deviceId)
+{
+    boost::mutex::scoped_lock lock(mMutex);
+
+    mDetails.erase(deviceId);
+
+    if(mDraining){
+        mInvalidated.insert(deviceId);
+    }
+}
+
+void InterfaceDetailsCache::drain()
+{
+    TRACE_SPAN("InterfaceDetailsCache::drain");
+
+    std::vector<Request> requests;
+    std::map<std::string, InterfaceDetailsPtr> resolved;
+
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+        requests.swap(mRequests);
+        mDraining = true;
+
+        for(auto& request : requests)
+        {
+            for(auto& info : request.interfaces)
+            {
+                auto cached = mDetails.find(info.id);
+                resolved[info.id] = cached != mDetails.end()? cached->second : InterfaceDetailsPtr();
+            }
+        }
+    }
+
+    /**< Every missing device is read once, however many requests want it */
+    std::map<std::string, InterfaceDetailsPtr> fresh;
+    for(auto& request : requests)
+    {
+        for(auto& info : request.interfaces)
+        {
+            InterfaceDetailsPtr& details = resolved[info.id];
+            if(details == nullptr && fresh.find(info.id) == fresh.end())
+            {
+                details = read(info.name);
+                fresh[info.id] = details;
+            }
+        }
+    }
+
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+
+        for(auto& details : fresh)
+        {
+            if(details.second != nullptr && mInvalidated.find(details.first) == mInvalidated.end()){
+                mDetails[details.first] = details.second;
+            }
+        }
+
+        mInvalidated.clear();
+        mDraining = false;
+    }
+
+    for(auto& request : requests)
+    {
+        std::vector<InterfaceDetailsPtr> details;
+        details.reserve(request.interfaces.size());
+
+        for(auto& info : request.interfaces){
+            details.push_back(resolved[info.id]);
+        }
+
+        request.callback(details);
+    }
+}
+
+InterfaceDetailsPtr InterfaceDetailsCache::read(const std::string& name) const
+{
+    TRACE_SPAN("InterfaceDetailsCache::read");
+
+    const std::string path = mPath + "/" + name;
+    char value[SYSFS_ATTRIBUTE_SIZE];
+
+    /**< Every netdev has an mtu, a device without one is gone */
+    if(name.empty() || !readValue(path + "/" + DETAILS_ATTRIBUTE_MTU, value)){
+        return InterfaceDetailsPtr();
+    }
+
+    std::shared_ptr<InterfaceDetails> details(new InterfaceDetails);
+    details->mtu = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+
+    /**< Reading the speed fails while the link is down */
+    if(readValue(path + "/" + DETAILS_ATTRIBUTE_SPEED, value)){
+        details->speedMbps = std::max<long>(strtol(value, nullptr, 10), -1);
+    }
+
+    details->driver = readLinkName(path + "/" + DETAILS_LINK_DRIVER);
+    details->master = readLinkName(path + "/" + DETAILS_LINK_MASTER);
+    details->parent = findLowerDevice(path);
+
+    return details;
+}
+
+InterfaceDetailsCache::~InterfaceDetailsCache()
+{
+    mWork.reset();
+    mWorkerService.stop();
+
+    if(mWorker.joinable()){
+        mWorker.join();
+    }
+}
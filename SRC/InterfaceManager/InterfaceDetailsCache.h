@@ -0,0 +1,79 @@
+#ifndef INTERFACEDETAILSCACHE_H
+#define INTERFACEDETAILSCACHE_H
+
+/**
+* @file InterfaceDetailsCache.h
+* @brief Contains a cache of interface details resolved from sysfs on a worker thread
+*/
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "InterfaceManagerImplSysfs.h"
+
+#define DETAILS_ATTRIBUTE_MTU           "mtu"
+#define DETAILS_ATTRIBUTE_SPEED         "speed"
+#define DETAILS_LINK_DRIVER             "device/driver"
+#define DETAILS_LINK_MASTER             "master"
+#define DETAILS_LOWER_PREFIX            "lower_"
+
+typedef std::function<void (const std::vector<InterfaceDetailsPtr>& details)> DetailsCallback;
+
+////////////////////////////////////////////////////////////
+///////          InterfaceDetailsCache            //////////
+////////////////////////////////////////////////////////////
+
+/**
+* @class InterfaceDetailsCache
+* @brief Details are read on first request and kept until the device is invalidated.
+*  Requests queued while the worker is busy are served by a single pass that reads
+*  every missing device once. The worker thread is only started by the first read.
+*  Speeds are read from sysfs, which reports what ethtool does for most drivers
+*/
+
+class InterfaceDetailsCache
+{
+private:
+    struct Request
+    {
+        std::vector<InterfaceInfo> interfaces;
+        DetailsCallback callback;
+    };
+
+public:
+    InterfaceDetailsCache(const std::string& path = SYSFS_NET_PATH);
+    ~InterfaceDetailsCache();
+
+    /**< The callback gets the details in the order of the interfaces, nullptr for unreadable ones.
+         It is called right away if all of them are cached, on the worker otherwise */
+    void fetch(const std::vector<InterfaceInfo>& interfaces, const DetailsCallback& callback);
+
+    InterfaceDetailsPtr getCached(const std::string& deviceId) const;
+    void invalidate(const std::string& deviceId);   /**< Cheap enough for the event path */
+
+    InterfaceDetailsPtr read(const std::string& name) const;   /**< Reads the details on the calling thread */
+
+private:
+    void drain();
+
+private:
+    std::string mPath;
+    std::map<std::string, InterfaceDetailsPtr> mDetails;   /**< By device id */
+    std::vector<Request> mRequests;
+    bool mDraining;
+    std::set<std::string> mInvalidated;        /**< Devices invalidated during the running pass, their reads are not cached */
+    mutable boost::mutex mMutex;
+
+    boost::asio::io_service mWorkerService;
+    std::unique_ptr<boost::asio::io_service::work> mWork;
+    boost::thread mWorker;
+    std::once_flag mWorkerStarted;
+};
+
+#endif // INTERFACEDETAILSCACHE_H
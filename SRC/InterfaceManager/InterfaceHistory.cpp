@@ -0,0 +1,360 @@
+#include "InterfaceHistory.h"
+
+#include <algorithm>
+#include <limits>
+
+#define HISTORY_RING_OVERHEAD       (sizeof(std::pair<const std::string, Ring>) + 4 * sizeof(void*))
+#define HISTORY_STRING_OVERHEAD     (2 * sizeof(std::string) + sizeof(uint32_t) + 4 * sizeof(void*))
+
+namespace
+{
+    const HistoryTime historyEpoch(boost::gregorian::date(1970, 1, 1));
+}
+
+////////////////////////////////////////////////////////////
+///////            InterfaceHistory               //////////
+////////////////////////////////////////////////////////////
+
+InterfaceHistory::InterfaceHistory(const size_t& maxBytes, const size_t& recordsPerInterface) :
+    mMaxBytes(maxBytes),
+    mRecordsPerInterface(std::max<size_t>(recordsPerInterface, 1)),
+    mRecordBytes(0),
+    mStringBytes(0),
+    mCompactedStringBytes(0),
+    mCompactionRequested(false)
+{
+
+}
+
+bool InterfaceHistory::record(const InterfaceInfo& info, const bool& action)
+{
+    return record(info, action, boost::posix_time::microsec_clock::universal_time());
+}
+
+bool InterfaceHistory::record(const InterfaceInfo& info, const bool& action, const HistoryTime& time)
+{
+    boost::mutex::scoped_lock lock(mMutex);
+    uint64_t now = toMsec(time);
+
+    auto stored = mRings.find(info.id);
+    if(stored == mRings.end())
+    {
+        Ring ring;
+        ring.id = intern(info.id);
+        ring.oldestMsec = ring.newestMsec = now;
+        ring.head = 0;
+        ring.limit = mRecordsPerInterface;
+
+        stored = mRings.insert(std::make_pair(info.id, ring)).first;
+        mRecordBytes += HISTORY_RING_OVERHEAD + info.id.size();
+    }
+
+    Ring& ring = stored->second;
+
+    /**< The clock may have been set back */
+    now = std::max(now, ring.newestMsec);
+
+    /**< Records more than 49 days older than the new one do not fit the delta and are dropped */
+    if(now - ring.newestMsec > std::numeric_limits<uint32_t>::max())
+    {
+        ring.records.clear();
+        ring.head = 0;
+    }
+
+    if(ring.records.empty()){
+        ring.oldestMsec = now;
+    }
+
+    Record record;
+    record.deltaMsec = static_cast<uint32_t>(ring.records.empty()? 0 : now - ring.newestMsec);
+    record.name = intern(info.name);
+    record.hwAddr = intern(info.hwAddr);
+    record.type = static_cast<uint8_t>(info.type);
+    record.action = action;
+
+    if(ring.records.size() < ring.limit)
+    {
+        size_t capacity = ring.records.capacity();
+        ring.records.push_back(record);
+        mRecordBytes += (ring.records.capacity() - capacity) * sizeof(Record);
+    }
+    else
+    {
+        /**< Overwrites the oldest record, the next one becomes the oldest */
+        size_t next = (ring.head + 1) % ring.records.size();
+        ring.oldestMsec = next == ring.head? now : ring.oldestMsec + ring.records[next].deltaMsec;
+        ring.records[ring.head] = record;
+        ring.head = next;
+    }
+
+    ring.newestMsec = now;
+
+    /**< Forgetting interfaces would not help while most strings are garbage */
+    if(!isCompactionDue()){
+        enforceLimit(&ring);
+    }
+
+    if(mRecordBytes + mStringBytes <= mMaxBytes){
+        return false;
+    }
+
+    bool requested = mCompactionRequested;
+    mCompactionRequested = true;
+
+    return !requested;
+}
+
+void InterfaceHistory::compact()
+{
+    boost::mutex::scoped_lock lock(mMutex);
+
+    /**< Shrunk rings may grow again into the memory the strings have freed */
+    restoreLimits();
+    compactStrings();
+    mCompactionRequested = false;
+    enforceLimit(nullptr);
+}
+
+HistoryEvents InterfaceHistory::getRange(const HistoryTime& from, const HistoryTime& to) const
+{
+    boost::mutex::scoped_lock lock(mMutex);
+    HistoryEvents events;
+
+    for(auto& ring : mRings){
+        appendRing(ring.second, toMsec(from), toMsec(to), events);
+    }
+
+    std::stable_sort(events.begin(), events.end(),
+                     [](const HistoryEvent& left, const HistoryEvent& right){ return left.time < right.time; });
+
+    return events;
+}
+
+HistoryEvents InterfaceHistory::getInterfaceHistory(const std::string& deviceId, const HistoryTime& from, const HistoryTime& to) const
+{
+    boost::mutex::scoped_lock lock(mMutex);
+    HistoryEvents events;
+
+    auto ring = mRings.find(deviceId);
+    if(ring != mRings.end()){
+        appendRing(ring->second, toMsec(from), toMsec(to), events);
+    }
+
+    return events;
+}
+
+void InterfaceHistory::appendRing(const Ring& ring, const uint64_t& firstMsec, const uint64_t& lastMsec, HistoryEvents& events) const
+{
+    if(ring.records.empty() || ring.newestMsec < firstMsec || ring.oldestMsec > lastMsec){
+        return;
+    }
+
+    uint64_t time = ring.oldestMsec;
+    size_t size = ring.records.size();
+
+    for(size_t i = 0; i < size; ++i)
+    {
+        const Record& record = ring.records[(ring.head + i) % size];
+        if(i){
+            time += record.deltaMsec;
+        }
+
+        if(time > lastMsec){
+            break;
+        }
+
+        if(time < firstMsec){
+            continue;
+        }
+
+        HistoryEvent event;
+        event.time = fromMsec(time);
+        event.info.id = mStrings[ring.id];
+        event.info.name = mStrings[record.name];
+        event.info.hwAddr = mStrings[record.hwAddr];
+        event.info.type = static_cast<InterfaceType>(record.type);
+        event.action = record.action;
+
+        events.push_back(event);
+    }
+}
+
+void InterfaceHistory::setMaxBytes(const size_t& maxBytes)
+{
+    boost::mutex::scoped_lock lock(mMutex);
+
+    mMaxBytes = maxBytes;
+
+    /**< Garbage strings go first, so only live records are dropped to fit */
+    restoreLimits();
+    compactStrings();
+    enforceLimit(nullptr);
+}
+
+size_t InterfaceHistory::getMaxBytes() const
+{
+    boost::mutex::scoped_lock lock(mMutex);
+    return mMaxBytes;
+}
+
+size_t InterfaceHistory::getMemoryUsage() const
+{
+    boost::mutex::scoped_lock lock(mMutex);
+    return mRecordBytes + mStringBytes;
+}
+
+void InterfaceHistory::clear()
+{
+    boost::mutex::scoped_lock lock(mMutex);
+
+    mRings.clear();
+    mStrings.clear();
+    mStringIndex.clear();
+    mRecordBytes = mStringBytes = mCompactedStringBytes = 0;
+    mCompactionRequested = false;
+}
+
+uint32_t InterfaceHistory::intern(const std::string& value)
+{
+    auto stored = mStringIndex.find(value);
+    if(stored != mStringIndex.end()){
+        return stored->second;
+    }
+
+    uint32_t index = static_cast<uint32_t>(mStrings.size());
+    mStrings.push_back(value);
+    mStringIndex.insert(std::make_pair(value, index));
+    mStringBytes += HISTORY_STRING_OVERHEAD + 2 * value.size();
+
+    return index;
+}
+
+void InterfaceHistory::enforceLimit(Ring* keep)
+{
+    while(mRecordBytes + mStringBytes > mMaxBytes)
+    {
+        auto victim = mRings.end();
+        for(auto ring = mRings.begin(); ring != mRings.end(); ++ring)
+        {
+            if(&ring->second != keep && (victim == mRings.end() || ring->second.newestMsec < victim->second.newestMsec)){
+                victim = ring;
+            }
+        }
+
+        if(victim == mRings.end())
+        {
+            if(keep != nullptr){
+                shrinkRing(*keep, mRecordBytes + mStringBytes - mMaxBytes);
+            }
+
+            break;
+        }
+
+        mRecordBytes -= HISTORY_RING_OVERHEAD + victim->first.size() + victim->second.records.capacity() * sizeof(Record);
+        mRings.erase(victim);
+    }
+}
+
+void InterfaceHistory::shrinkRing(Ring& ring, const size_t& excessBytes)
+{
+    size_t size = ring.records.size();
+    size_t unused = (ring.records.capacity() - size) * sizeof(Record);
+    size_t dropped = excessBytes > unused? std::min((excessBytes - unused + sizeof(Record) - 1) / sizeof(Record), size - 1) : 0;
+
+    /**< Copies the kept records in order, so the oldest one is at the front */
+    std::vector<Record> records;
+    records.reserve(size - dropped);
+
+    for(size_t i = 0; i < size; ++i)
+    {
+        const Record& record = ring.records[(ring.head + i) % size];
+
+        if(i && i <= dropped){
+            ring.oldestMsec += record.deltaMsec;
+        }
+
+        if(i >= dropped){
+            records.push_back(record);
+        }
+    }
+
+    mRecordBytes -= (ring.records.capacity() - records.capacity()) * sizeof(Record);
+    ring.records.swap(records);
+    ring.head = 0;
+    ring.limit = ring.records.size();
+}
+
+void InterfaceHistory::restoreLimits()
+{
+    for(auto& stored : mRings)
+    {
+        Ring& ring = stored.second;
+
+        /**< Records are appended behind the newest one only while the oldest one is at the front */
+        std::rotate(ring.records.begin(), ring.records.begin() + ring.head, ring.records.end());
+        ring.head = 0;
+        ring.limit = mRecordsPerInterface;
+    }
+}
+
+bool InterfaceHistory::isCompactionDue() const
+{
+    /**< Strings of overwritten records and forgotten interfaces are only dropped by a compaction,
+     *   the limit is enforced on records until the first one has given a baseline */
+    return mCompactedStringBytes && mStringBytes > 2 * mCompactedStringBytes;
+}
+
+void InterfaceHistory::compactStrings()
+{
+    std::vector<std::string> strings;
+    std::unordered_map<std::string, uint32_t> stringIndex;
+    size_t stringBytes = 0;
+
+    auto remap = [&](uint32_t& index)
+    {
+        const std::string& value = mStrings[index];
+
+        auto stored = stringIndex.find(value);
+        if(stored == stringIndex.end())
+        {
+            stored = stringIndex.insert(std::make_pair(value, static_cast<uint32_t>(strings.size()))).first;
+            strings.push_back(value);
+            stringBytes += HISTORY_STRING_OVERHEAD + 2 * value.size();
+        }
+
+        index = stored->second;
+    };
+
+    for(auto& ring : mRings)
+    {
+        remap(ring.second.id);
+
+        for(auto& record : ring.second.records)
+        {
+            remap(record.name);
+            remap(record.hwAddr);
+        }
+    }
+
+    mStrings.swap(strings);
+    mStringIndex.swap(stringIndex);
+    mStringBytes = mCompactedStringBytes = stringBytes;
+}
+
+uint64_t InterfaceHistory::toMsec(const HistoryTime& time)
+{
+    if(time.is_pos_infinity()){
+        return std::numeric_limits<uint64_t>::max();
+    }
+
+    if(time.is_special() || time <= historyEpoch){
+        return 0;
+    }
+
+    return (time - historyEpoch).total_milliseconds();
+}
+
+HistoryTime InterfaceHistory::fromMsec(const uint64_t& msec)
+{
+    return historyEpoch + boost::posix_time::milliseconds(msec);
+}
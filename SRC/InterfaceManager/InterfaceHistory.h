@@ -0,0 +1,123 @@
+#ifndef INTERFACEHISTORY_H
+#define INTERFACEHISTORY_H
+
+/**
+* @file InterfaceHistory.h
+* @brief Contains a bounded in-memory history of interface updates
+*/
+
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "AbstractInterfaceManagerImpl.h"
+
+#define HISTORY_DEFAULT_MAX_BYTES       (4 * 1024 * 1024)
+#define HISTORY_DEFAULT_RECORDS         256     /**< Per interface */
+
+typedef boost::posix_time::ptime HistoryTime;
+
+/**
+* @class HistoryEvent
+* @brief A single update as returned by history queries
+*/
+
+struct HistoryEvent
+{
+    HistoryTime time;
+    InterfaceInfo info;     /**< Without sequence and generation */
+    bool action;
+};
+
+typedef std::vector<HistoryEvent> HistoryEvents;
+
+////////////////////////////////////////////////////////////
+///////            InterfaceHistory               //////////
+////////////////////////////////////////////////////////////
+
+/**
+* @class InterfaceHistory
+* @brief Every interface gets a ring of fixed-size records. A record keeps the time passed
+*  since the previous record of its ring in msec and indexes of interned strings, so names
+*  and addresses are stored once. When the memory limit is reached the least recently
+*  updated interface is forgotten, the oldest records of the last one are dropped.
+*  Recording only locks for the time of the update. Strings no record refers to are
+*  dropped by compact(), the history may exceed the limit by them until it is called.
+*  Times are UTC, queries include both ends of the range
+*/
+
+class InterfaceHistory
+{
+private:
+    struct Record
+    {
+        uint32_t deltaMsec;                     /**< Since the previous record of the ring, unused for the oldest one */
+        uint32_t name;
+        uint32_t hwAddr;
+        uint8_t type;
+        uint8_t action;
+    };
+
+    struct Ring
+    {
+        uint32_t id;
+        uint64_t oldestMsec;                    /**< Absolute times of the oldest and the newest records */
+        uint64_t newestMsec;
+        size_t head;                            /**< Index of the oldest record */
+        size_t limit;                           /**< Records kept, lowered if the ring alone exceeds the memory limit */
+        std::vector<Record> records;
+    };
+
+    typedef std::unordered_map<std::string, Ring> RingStorage;
+
+public:
+    InterfaceHistory(const size_t& maxBytes = HISTORY_DEFAULT_MAX_BYTES,
+                     const size_t& recordsPerInterface = HISTORY_DEFAULT_RECORDS);
+
+    /**< Return true once strings should be compacted, call compact() off the recording thread then */
+    bool record(const InterfaceInfo& info, const bool& action);
+    bool record(const InterfaceInfo& info, const bool& action, const HistoryTime& time);
+    void compact();
+
+    HistoryEvents getRange(const HistoryTime& from, const HistoryTime& to) const;     /**< All interfaces, ordered by time */
+    HistoryEvents getInterfaceHistory(const std::string& deviceId,
+                                      const HistoryTime& from = boost::posix_time::min_date_time,
+                                      const HistoryTime& to = boost::posix_time::max_date_time) const;
+
+    void setMaxBytes(const size_t& maxBytes);   /**< Forgets interfaces until the history fits */
+    size_t getMaxBytes() const;
+    size_t getMemoryUsage() const;
+    void clear();
+
+private:
+    /**< The functions below expect mMutex to be locked */
+    uint32_t intern(const std::string& value);
+    void appendRing(const Ring& ring, const uint64_t& firstMsec, const uint64_t& lastMsec, HistoryEvents& events) const;
+    void enforceLimit(Ring* keep);              /**< keep is the ring being written to, it is shrunk last */
+    void shrinkRing(Ring& ring, const size_t& excessBytes);    /**< Drops the oldest records, keeps the newest one */
+    void restoreLimits();                       /**< Lets shrunk rings grow back to mRecordsPerInterface */
+    void compactStrings();                      /**< Drops strings no record refers to */
+    bool isCompactionDue() const;
+
+    static uint64_t toMsec(const HistoryTime& time);
+    static HistoryTime fromMsec(const uint64_t& msec);
+
+private:
+    size_t mMaxBytes;
+    size_t mRecordsPerInterface;
+    size_t mRecordBytes;                        /**< Memory held by all rings */
+    size_t mStringBytes;                        /**< Memory held by interned strings */
+    size_t mCompactedStringBytes;               /**< After the last compaction */
+    bool mCompactionRequested;                  /**< record() has returned true and compact() has not run since */
+
+    RingStorage mRings;
+    std::vector<std::string> mStrings;
+    std::unordered_map<std::string, uint32_t> mStringIndex;
+
+    mutable boost::mutex mMutex;
+};
+
+#endif // INTERFACEHISTORY_H
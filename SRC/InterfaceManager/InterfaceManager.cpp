@@ -1,65 +1,142 @@
 #include "InterfaceManager.h"
+#include "Tracer.h"
 
 ////////////////////////////////////////////////////////////
 ///////            InterfaceManager               //////////
 ////////////////////////////////////////////////////////////
 
 InterfaceManager::InterfaceManager(io_service& io) :
-    mEventLoop(io),
-    mWork(new io_service::work(mImplService))
-{           
-    mImpl = ImplPtr(new InterfaceManagerImpl);       
-    mThreadGroop.create_thread(boost::bind(&io_service::run, &mImplService));
+    InterfaceManager(io, ImplPtr(new InterfaceManagerImpl))
+{
 
-    /**< Connecting signals */
-    mImpl->interfaceListUpdateSignal.connect(boost::bind(&InterfaceManager::onInterfaceUpdateSlot, this, _1, _2));
-    mImpl->updateFailedSignal.connect(boost::bind(&InterfaceManager::onUpdateFailedSlot, this));
 }
 
+InterfaceManager::InterfaceManager(io_service& io, ImplPtr impl) :
+    mManager(io, *this, std::move(impl))
+{
+    mManager.setHistoryLimit(HISTORY_DEFAULT_MAX_BYTES);
+}
 
 void InterfaceManager::startListening()
 {
-    mImplService.dispatch(boost::bind(&InterfaceManagerImpl::startListening, mImpl.get()));
+    mManager.startListening();
 }
 
 void InterfaceManager::stopListening()
 {
-    mImpl->stopListening();
+    mManager.stopListening();
 }
 
 void InterfaceManager::updateDevices()
 {
-    mImpl->updateDevices();
+    mManager.updateDevices();
+}
+
+void InterfaceManager::pause()
+{
+    mManager.pause();
+}
+
+void InterfaceManager::resume()
+{
+    mManager.resume();
+}
+
+bool InterfaceManager::isPaused() const
+{
+    return mManager.isPaused();
 }
 
 InterfaceInfoStorage InterfaceManager::getInterfaceData() const
 {
-    return mImpl->getInterfacesData();
+    return mManager.getInterfaceData();
 }
 
-void InterfaceManager::onUpdateFailedSlot()
-{     
-   mEventLoop.post(boost::bind(&InterfaceManager::sendUpdateFailedSignal, this));
+InterfaceInfoStorage InterfaceManager::getInterfaceData(uint64_t& sequence) const
+{
+    return mManager.getInterfaceData(sequence);
 }
 
-void InterfaceManager::onInterfaceUpdateSlot(const InterfaceInfo& info, const bool& action)
+ImplPtr InterfaceManager::createImpl(const std::string& backend)
 {
-    mEventLoop.post(boost::bind(&InterfaceManager::sendInterfaceUpdateSignal, this, info, action));
+    if(backend == BACKEND_NETWORK_MANAGER){
+        return ImplPtr(new InterfaceManagerImpl);
+    }
+
+    if(backend == BACKEND_SYSFS){
+        return ImplPtr(new SysfsInterfaceManagerImpl);
+    }
+
+    if(backend == BACKEND_AUTO)
+    {
+        try{
+            return ImplPtr(new InterfaceManagerImpl);
+        }
+        catch(const std::exception& e){
+            return ImplPtr(new SysfsInterfaceManagerImpl);
+        }
+    }
+
+    throw std::runtime_error("Unknown backend " + backend);
 }
 
-void InterfaceManager::sendUpdateFailedSignal()
+void InterfaceManager::setRefreshPeriod(const std::string& deviceId, const uint32_t& periodMsec)
 {
-    updateFailedSignal();
+    mManager.setRefreshPeriod(deviceId, periodMsec);
+}
+
+void InterfaceManager::resyncDevice(const std::string& deviceId, const ResyncCallback& callback)
+{
+    mManager.resyncDevice(deviceId, callback);
+}
+
+uint64_t InterfaceManager::getLostUpdateCount() const
+{
+    return mManager.getLostUpdateCount();
 }
 
-void InterfaceManager::sendInterfaceUpdateSignal(const InterfaceInfo& info, const bool& action)
+uint64_t InterfaceManager::getSkippedUpdateCount() const
 {
+    return mManager.getSkippedUpdateCount();
+}
+
+HistoryEvents InterfaceManager::getHistory(const HistoryTime& from, const HistoryTime& to) const
+{
+    return mManager.getHistory(from, to);
+}
+
+HistoryEvents InterfaceManager::getInterfaceHistory(const std::string& deviceId, const HistoryTime& from, const HistoryTime& to) const
+{
+    return mManager.getInterfaceHistory(deviceId, from, to);
+}
+
+void InterfaceManager::setHistoryLimit(const size_t& maxBytes)
+{
+    mManager.setHistoryLimit(maxBytes);
+}
+
+void InterfaceManager::getInterfaceDetails(const std::vector<std::string>& deviceIds, const InterfaceDetailsCallback& callback)
+{
+    mManager.getInterfaceDetails(deviceIds, callback);
+}
+
+InterfaceDetailsPtr InterfaceManager::getInterfaceDetails(const std::string& deviceId)
+{
+    return mManager.getInterfaceDetails(deviceId);
+}
+
+void InterfaceManager::onInterfaceUpdate(const InterfaceInfo& info, const bool& action)
+{
+    TRACE_SPAN("InterfaceManager::onInterfaceUpdate");
     interfaceUpdateSignal(info, action);
 }
 
+void InterfaceManager::onUpdateFailed()
+{
+    updateFailedSignal();
+}
+
 InterfaceManager::~InterfaceManager()
-{    
-    stopListening();
-    mImplService.stop();
-    mThreadGroop.join_all();
+{
+
 }
@@ -13,10 +13,12 @@
 #include <boost/asio.hpp>
 #include <boost/bind.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
-#include <boost/thread/thread.hpp>
+
+#include "BasicInterfaceManager.h"
 
 #ifdef __linux__
     #include "InterfaceManagerImplLinux.h"
+    #include "InterfaceManagerImplSysfs.h"
 #elif defined (_WIN32) || defined (_WIN64)
     #error "Windows impl is yet to be done"
 #else
@@ -26,43 +28,78 @@
 using namespace boost::asio;
 
 typedef boost::posix_time::millisec msec;
-typedef std::unique_ptr<InterfaceManagerImpl> ImplPtr;
-typedef std::unique_ptr<io_service::work> WorkPtr;
+
+#define BACKEND_NETWORK_MANAGER         "nm"
+#define BACKEND_SYSFS                   "sysfs"
+#define BACKEND_AUTO                    "auto"     /**< NetworkManager if it is available, sysfs otherwise */
+
+typedef std::unique_ptr<AbstractInterfaceManagerImpl> ImplPtr;
 
 ////////////////////////////////////////////////////////////
 ///////            InterfaceManager               //////////
 ////////////////////////////////////////////////////////////
 
+/**
+* @class InterfaceManager
+* @brief Delivers updates to the passed event loop, which may be run by any number of threads.
+*  Updates of one device are delivered in order through the same strand,
+*  updates of different devices may be handled in parallel.
+*  A thin wrapper over BasicInterfaceManager with a runtime backend, see it for the details.
+*  The history of updates is kept by default
+*/
+
 class InterfaceManager
 {
+    /**< Call the handler functions */
+    friend class StrandDispatch;
+    friend class BasicInterfaceManager<AbstractInterfaceManagerImpl, InterfaceManager>;
+
 public:
     InterfaceManager(io_service& io);
+    InterfaceManager(io_service& io, ImplPtr impl);   /**< Uses a custom backend instead of the platform one */
     virtual ~InterfaceManager();
 
     void startListening();
     void stopListening();
     void updateDevices();
+
+    void pause();
+    void resume();
+    bool isPaused() const;
+
     InterfaceInfoStorage getInterfaceData() const;
+    InterfaceInfoStorage getInterfaceData(uint64_t& sequence) const;  /**< Updates up to sequence are reflected in the copy */
+
+    static ImplPtr createImpl(const std::string& backend);   /**< Creates a backend by name, throws for unknown names */
+
+    void setRefreshPeriod(const std::string& deviceId, const uint32_t& periodMsec);
+    void resyncDevice(const std::string& deviceId, const ResyncCallback& callback = ResyncCallback());
+    uint64_t getLostUpdateCount() const;
+    uint64_t getSkippedUpdateCount() const;
 
-private:   
-    /**< Slots */ 
-    void onUpdateFailedSlot();
-    void onInterfaceUpdateSlot(const InterfaceInfo& info, const bool& action);
+    HistoryEvents getHistory(const HistoryTime& from, const HistoryTime& to) const;
+    HistoryEvents getInterfaceHistory(const std::string& deviceId,
+                                      const HistoryTime& from = boost::posix_time::min_date_time,
+                                      const HistoryTime& to = boost::posix_time::max_date_time) const;
+    void setHistoryLimit(const size_t& maxBytes);
 
-     /**< The functions below are used to force signals call slots in the main thread */
-    void sendUpdateFailedSignal();    
-    void sendInterfaceUpdateSignal(const InterfaceInfo& info, const bool& action);  
+    void getInterfaceDetails(const std::vector<std::string>& deviceIds, const InterfaceDetailsCallback& callback);
+    InterfaceDetailsPtr getInterfaceDetails(const std::string& deviceId);
 
-private:   
-    ImplPtr mImpl;                             /**<  An implementation depends on the platform */   
-    io_service& mEventLoop;
-    io_service mImplService;
-    boost::thread_group mThreadGroop;
-    WorkPtr mWork;
+private:
+    /**< Handler of mManager, called through the device strands */
+    void onInterfaceUpdate(const InterfaceInfo& info, const bool& action);
+    void onUpdateFailed();
 
-public: 
+public:
     updateSignal interfaceUpdateSignal;          /**< Emitted if an interface is added or removed */
     errorSignal  updateFailedSignal;             /**< Emitted on update error */
+
+private:
+    /**< Declared after the signals, so the backend thread is stopped before they are destroyed */
+    BasicInterfaceManager<AbstractInterfaceManagerImpl, InterfaceManager> mManager;
 };
 
+typedef std::unique_ptr<InterfaceManager> InterfaceManagerPtr;
+
 #endif // INTERFACEMANAGER_H
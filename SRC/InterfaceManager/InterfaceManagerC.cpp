@@ -0,0 +1,370 @@
+#include "InterfaceManagerC.h"
+#include "InterfaceManager.h"
+
+#include <mutex>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace
+{
+    bool copyInline(char* destination, const size_t& size, const std::string& source)
+    {
+        size_t length = std::min(source.size(), size - 1);
+        memcpy(destination, source.data(), length);
+        destination[length] = '\0';
+
+        return length == source.size();
+    }
+
+    void assignEvent(ifmon_event& event, const InterfaceInfo& info, const bool& action)
+    {
+        bool complete = copyInline(event.id, sizeof(event.id), info.id);
+        complete = copyInline(event.name, sizeof(event.name), info.name) && complete;
+        complete = copyInline(event.hw_addr, sizeof(event.hw_addr), info.hwAddr) && complete;
+
+        event.type = static_cast<uint32_t>(info.type);
+        event.action = action? IFMON_ACTION_ADDED : IFMON_ACTION_REMOVED;
+        event.truncated = !complete;
+        event.reserved = 0;
+        event.sequence = info.sequence;
+        event.generation = info.generation;
+    }
+}
+
+////////////////////////////////////////////////////////////
+///////              ifmon_manager                //////////
+////////////////////////////////////////////////////////////
+
+/**
+* @class ifmon_manager
+* @brief The eventfd counter is nonzero exactly while the ring holds updates. The ring
+*  is changed under mMutex, so the host never misses a wakeup. Devices whose updates
+*  the backend has lost are reread on a worker thread started by the first reread,
+*  their changes reach the ring as usual updates
+*/
+
+struct ifmon_manager : private ImplListener
+{
+public:
+    ifmon_manager(ImplPtr impl, const size_t& capacity);
+    ~ifmon_manager();
+
+    int update();
+    int start();
+    void stop();
+
+    int getFd() const;
+    size_t drain(ifmon_event* events, const size_t& capacity);
+    size_t snapshot(ifmon_event* events, const size_t& capacity);
+
+    uint64_t getDropped() const;
+    uint64_t getFailures() const;
+
+private:
+    /**< ImplListener, called by the backend with its lock held */
+    void onInterfaceUpdate(const InterfaceInfo& info, const bool& action) override;
+    void onUpdateFailed() override;
+    void onResyncRequest(const std::string& deviceId, const uint64_t& skippedSequence) override;
+
+    void reread(const std::string& deviceId);   /**< Runs on the worker */
+
+    /**< The functions below expect mMutex to be locked */
+    void signal();
+    void clearSignal();
+
+private:
+    ImplPtr mImpl;
+    int mFd;
+    boost::thread mListener;
+    boost::mutex mListenerMutex;                /**< Serializes start() and stop() */
+
+    boost::asio::io_service mWorkerService;
+    std::unique_ptr<boost::asio::io_service::work> mWork;
+    boost::thread mWorker;
+    std::once_flag mWorkerStarted;
+
+    std::vector<ifmon_event> mRing;
+    size_t mHead;                               /**< The oldest queued update */
+    size_t mSize;
+    uint64_t mDropped;
+    uint64_t mFailures;
+    mutable boost::mutex mMutex;
+};
+
+ifmon_manager::ifmon_manager(ImplPtr impl, const size_t& capacity) :
+    mImpl(std::move(impl)),
+    mFd(-1),
+    mWork(new boost::asio::io_service::work(mWorkerService)),
+    mRing(capacity? capacity : IFMON_DEFAULT_CAPACITY),
+    mHead(0),
+    mSize(0),
+    mDropped(0),
+    mFailures(0)
+{
+    mFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(mFd < 0){
+        throw std::runtime_error("Error creating an eventfd");
+    }
+
+    mImpl->setListener(this);
+}
+
+int ifmon_manager::update()
+{
+    uint64_t failures = getFailures();
+    mImpl->updateDevices();
+
+    return getFailures() == failures? 0 : -1;
+}
+
+int ifmon_manager::start()
+{
+    boost::mutex::scoped_lock lock(mListenerMutex);
+
+    if(mListener.joinable()){
+        return -1;
+    }
+
+    mImpl->prepareListening();
+    mListener = boost::thread(boost::bind(&AbstractInterfaceManagerImpl::startListening, mImpl.get()));
+    return 0;
+}
+
+void ifmon_manager::stop()
+{
+    boost::mutex::scoped_lock lock(mListenerMutex);
+
+    if(mListener.joinable())
+    {
+        mImpl->stopListening();
+        mListener.join();
+    }
+}
+
+int ifmon_manager::getFd() const
+{
+    return mFd;
+}
+
+size_t ifmon_manager::drain(ifmon_event* events, const size_t& capacity)
+{
+    boost::mutex::scoped_lock lock(mMutex);
+
+    size_t count = std::min(capacity, mSize);
+    for(size_t i = 0; i < count; ++i){
+        events[i] = mRing[(mHead + i) % mRing.size()];
+    }
+
+    mHead = (mHead + count) % mRing.size();
+    mSize -= count;
+
+    if(!mSize){
+        clearSignal();
+    }
+
+    return count;
+}
+
+size_t ifmon_manager::snapshot(ifmon_event* events, const size_t& capacity)
+{
+    InterfaceInfoStorage interfaces = mImpl->getInterfacesData();
+
+    size_t count = 0;
+    for(auto& interface : interfaces)
+    {
+        if(count < capacity){
+            assignEvent(events[count], interface.second, true);
+        }
+
+        ++count;
+    }
+
+    return count;
+}
+
+uint64_t ifmon_manager::getDropped() const
+{
+    boost::mutex::scoped_lock lock(mMutex);
+    return mDropped;
+}
+
+uint64_t ifmon_manager::getFailures() const
+{
+    boost::mutex::scoped_lock lock(mMutex);
+    return mFailures;
+}
+
+void ifmon_manager::onInterfaceUpdate(const InterfaceInfo& info, const bool& action)
+{
+    boost::mutex::scoped_lock lock(mMutex);
+
+    /**< The newest update is dropped, the host finds the gap in the generations or by ifmon_dropped */
+    if(mSize == mRing.size())
+    {
+        ++mDropped;
+        return;
+    }
+
+    bool pending = mSize != 0;
+    assignEvent(mRing[(mHead + mSize) % mRing.size()], info, action);
+    ++mSize;
+
+    if(!pending){
+        signal();
+    }
+}
+
+void ifmon_manager::onUpdateFailed()
+{
+    boost::mutex::scoped_lock lock(mMutex);
+    ++mFailures;
+}
+
+void ifmon_manager::onResyncRequest(const std::string& deviceId, const uint64_t&)
+{
+    /**< The backend lock is held, so the device is reread later on the worker */
+    std::call_once(mWorkerStarted, [this](){ mWorker = boost::thread(boost::bind(&boost::asio::io_service::run, &mWorkerService)); });
+    mWorkerService.post(boost::bind(&ifmon_manager::reread, this, deviceId));
+}
+
+void ifmon_manager::reread(const std::string& deviceId)
+{
+    try
+    {
+        if(mImpl->updateDevice(deviceId)){
+            return;
+        }
+    }
+    catch(const std::exception& e){}
+
+    onUpdateFailed();
+}
+
+void ifmon_manager::signal()
+{
+    uint64_t value = 1;
+    ssize_t result = write(mFd, &value, sizeof(value));
+    (void)result;
+}
+
+void ifmon_manager::clearSignal()
+{
+    uint64_t value = 0;
+    ssize_t result = read(mFd, &value, sizeof(value));
+    (void)result;
+}
+
+ifmon_manager::~ifmon_manager()
+{
+    stop();
+
+    mWork.reset();
+    mWorkerService.stop();
+
+    if(mWorker.joinable()){
+        mWorker.join();
+    }
+
+    mImpl.reset();
+
+    if(mFd >= 0){
+        close(mFd);
+    }
+}
+
+////////////////////////////////////////////////////////////
+///////                 C API                     //////////
+////////////////////////////////////////////////////////////
+
+ifmon_manager* ifmonCreate(ImplPtr impl, const size_t& capacity)
+{
+    return new ifmon_manager(std::move(impl), capacity);
+}
+
+extern "C"
+{
+
+ifmon_manager* ifmon_create(const char* backend, size_t capacity, char* error, size_t error_size)
+{
+    try{
+        return ifmonCreate(InterfaceManager::createImpl(backend != nullptr? backend : BACKEND_AUTO), capacity);
+    }
+    catch(const std::exception& e)
+    {
+        if(error != nullptr && error_size){
+            copyInline(error, error_size, e.what());
+        }
+    }
+
+    return nullptr;
+}
+
+void ifmon_destroy(ifmon_manager* manager)
+{
+    delete manager;
+}
+
+int ifmon_update(ifmon_manager* manager)
+{
+    try{
+        return manager->update();
+    }
+    catch(const std::exception& e){
+        return -1;
+    }
+}
+
+int ifmon_start(ifmon_manager* manager)
+{
+    try{
+        return manager->start();
+    }
+    catch(const std::exception& e){
+        return -1;
+    }
+}
+
+void ifmon_stop(ifmon_manager* manager)
+{
+    try{
+        manager->stop();
+    }
+    catch(const std::exception& e){}
+}
+
+int ifmon_fd(const ifmon_manager* manager)
+{
+    return manager->getFd();
+}
+
+size_t ifmon_drain(ifmon_manager* manager, ifmon_event* events, size_t capacity)
+{
+    try{
+        return manager->drain(events, capacity);
+    }
+    catch(const std::exception& e){
+        return 0;
+    }
+}
+
+size_t ifmon_snapshot(ifmon_manager* manager, ifmon_event* events, size_t capacity)
+{
+    try{
+        return manager->snapshot(events, capacity);
+    }
+    catch(const std::exception& e){
+        return 0;
+    }
+}
+
+uint64_t ifmon_dropped(const ifmon_manager* manager)
+{
+    return manager->getDropped();
+}
+
+uint64_t ifmon_failures(const ifmon_manager* manager)
+{
+    return manager->getFailures();
+}
+
+}
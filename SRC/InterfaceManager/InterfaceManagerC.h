@@ -0,0 +1,80 @@
+#ifndef INTERFACEMANAGERC_H
+#define INTERFACEMANAGERC_H
+
+/**
+* @file InterfaceManagerC.h
+* @brief Contains a C interface of the interface manager for foreign event loops.
+*  Updates are queued into a ring of fixed-size records allocated by ifmon_create().
+*  The descriptor returned by ifmon_fd() is readable while updates are queued,
+*  the host drains them from its own thread. The backend keeps its listening thread.
+*  Functions are safe to call from any thread, except ifmon_destroy()
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define IFMON_ID_SIZE               128
+#define IFMON_NAME_SIZE             32
+#define IFMON_HWADDR_SIZE           32
+#define IFMON_DEFAULT_CAPACITY      1024
+
+#define IFMON_TYPE_ETH              0
+#define IFMON_TYPE_TUN              1
+#define IFMON_TYPE_LO               2
+#define IFMON_TYPE_UNKNOWN          3
+
+#define IFMON_ACTION_REMOVED        0
+#define IFMON_ACTION_ADDED          1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ifmon_manager ifmon_manager;
+
+typedef struct ifmon_event
+{
+    char id[IFMON_ID_SIZE];
+    char name[IFMON_NAME_SIZE];
+    char hw_addr[IFMON_HWADDR_SIZE];
+    uint32_t type;              /**< IFMON_TYPE_* */
+    uint32_t action;            /**< IFMON_ACTION_*, always IFMON_ACTION_ADDED in snapshots */
+    uint32_t truncated;         /**< Non-zero if a string did not fit */
+    uint32_t reserved;
+    uint64_t sequence;
+    uint64_t generation;
+} ifmon_event;
+
+/**< backend is "nm", "sysfs" or "auto", capacity 0 means IFMON_DEFAULT_CAPACITY.
+     Returns NULL on failure and writes the reason into error, if passed */
+ifmon_manager* ifmon_create(const char* backend, size_t capacity, char* error, size_t error_size);
+void ifmon_destroy(ifmon_manager* manager);
+
+int ifmon_update(ifmon_manager* manager);      /**< Rereads the device list without reporting it, 0 on success */
+int ifmon_start(ifmon_manager* manager);       /**< Starts listening, 0 on success */
+void ifmon_stop(ifmon_manager* manager);       /**< Returns once the backend has stopped, may be started again */
+
+int ifmon_fd(const ifmon_manager* manager);    /**< A non-blocking eventfd, never read it directly */
+
+/**< Moves up to capacity queued updates into events in order, returns their number.
+     Devices whose updates the backend has lost are reread on a worker thread, not here */
+size_t ifmon_drain(ifmon_manager* manager, ifmon_event* events, size_t capacity);
+
+/**< Fills up to capacity current interfaces, returns the total number, which may exceed capacity */
+size_t ifmon_snapshot(ifmon_manager* manager, ifmon_event* events, size_t capacity);
+
+uint64_t ifmon_dropped(const ifmon_manager* manager);   /**< Updates lost to a full ring, take a new snapshot if it grows */
+uint64_t ifmon_failures(const ifmon_manager* manager);  /**< Failed updates and rereads */
+
+#ifdef __cplusplus
+}
+
+#include <memory>
+
+class AbstractInterfaceManagerImpl;
+
+/**< Wraps a custom backend */
+ifmon_manager* ifmonCreate(std::unique_ptr<AbstractInterfaceManagerImpl> impl, const size_t& capacity);
+#endif
+
+#endif // INTERFACEMANAGERC_H
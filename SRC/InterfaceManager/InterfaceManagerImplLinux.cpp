@@ -1,29 +1,38 @@
 #include "InterfaceManagerImplLinux.h"
+#include "Tracer.h"
+
+#include <algorithm>
 
 ////////////////////////////////////////////////////////////
 ///////            InterfaceManagerImpl           //////////
 ////////////////////////////////////////////////////////////
 
-InterfaceManagerImpl::InterfaceManagerImpl() : mLoop (nullptr), mNetManagerProxy(nullptr)
+InterfaceManagerImpl::InterfaceManagerImpl() :
+    mLoop (nullptr),
+    mListening(false),
+    mStartEpoch(0),
+    mRunEpoch(0),
+    mStopEpoch(0),
+    mConnection(nullptr),
+    mDeviceAddedSubscription(0),
+    mDeviceRemovedSubscription(0)
 {   
+    TRACE_SPAN("InterfaceManagerImpl::InterfaceManagerImpl");
     GError* error = nullptr;  
 
     try
     {
-        mNetManagerProxy = g_dbus_proxy_new_for_bus_sync (G_BUS_TYPE_SYSTEM,
-                                                          G_DBUS_PROXY_FLAGS_NONE,
-                                                          NULL,
-                                                          NM_IFACE_NETWORKMANAGER,
-                                                          NM_IFACE_NETWORKMANAGER_PATH,
-                                                          NM_IFACE_NETWORKMANAGER,
-                                                          NULL,
-                                                          &error);
-
-        if(mNetManagerProxy == nullptr || error != nullptr){
-            throw std::runtime_error("Error init network manager proxy");
+        mConnection = g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, &error);
+
+        if(mConnection == nullptr || error != nullptr){
+            throw std::runtime_error("Error connecting to the system bus");
         }        
 
-        g_signal_connect(G_OBJECT(mNetManagerProxy), NM_SIGNAL_G_SIGNAL, G_CALLBACK(onNetManagerSignal), (gpointer)this);
+        mDeviceAddedSubscription = subscribe(NM_SIGNAL_DEVICE_ADDED);
+        mDeviceRemovedSubscription = subscribe(NM_SIGNAL_DEVICE_REMOVED);
+
+        /**< Created here, so stopListening never sees it half made */
+        mLoop = g_main_loop_new(NULL, FALSE);
     }
     catch(const std::exception& e)
     {
@@ -35,33 +44,82 @@ InterfaceManagerImpl::InterfaceManagerImpl() : mLoop (nullptr), mNetManagerProxy
             g_error_free(error);
         }
 
-        if(mNetManagerProxy != nullptr){
-            g_object_unref(mNetManagerProxy);
+        if(mConnection != nullptr){
+            g_object_unref(mConnection);
         }
 
         throw std::runtime_error(errorText);
     }
 }
 
+guint InterfaceManagerImpl::subscribe(const char* signalName)
+{
+    /**< Adds a match rule for this very signal instead of one for every signal of the interface */
+    return g_dbus_connection_signal_subscribe(mConnection,
+                                              NM_IFACE_NETWORKMANAGER,
+                                              NM_IFACE_NETWORKMANAGER,
+                                              signalName,
+                                              NM_IFACE_NETWORKMANAGER_PATH,
+                                              NULL,
+                                              G_DBUS_SIGNAL_FLAGS_NONE,
+                                              onNetManagerSignal,
+                                              (gpointer)this,
+                                              NULL);
+}
+
 void InterfaceManagerImpl::startListening()
 {           
-    if(mLoop == nullptr){       
-        mLoop = g_main_loop_new (NULL, FALSE);        
+    {
+        boost::mutex::scoped_lock lock(mLoopMutex);
+        mStartEpoch = std::max(mStartEpoch, ++mRunEpoch);
     }
 
-    if(!g_main_is_running(mLoop)){
-        g_main_loop_run (mLoop);
-    }
+    /**< A quit before g_main_loop_run would be lost, so the loop reports itself running from inside */
+    g_idle_add(onLoopStarted, (gpointer)this);
+    g_main_loop_run (mLoop);
+
+    boost::mutex::scoped_lock lock(mLoopMutex);
+    mListening = false;
 }
 
 void InterfaceManagerImpl::stopListening()
 {
-    if(mLoop != nullptr){
-        g_main_loop_quit(mLoop);        
-    }        
+    boost::mutex::scoped_lock lock(mLoopMutex);
+    mStopEpoch = mStartEpoch;
+
+    if(mListening)
+    {
+        g_main_loop_quit(mLoop);
+        mListening = false;
+    }
 }
 
-void InterfaceManagerImpl::onNetManagerSignal(GDBusProxy *proxy, gchar *sender, gchar *signal, GVariant *params, gpointer data)
+void InterfaceManagerImpl::prepareListening()
+{
+    boost::mutex::scoped_lock lock(mLoopMutex);
+    ++mStartEpoch;
+}
+
+gboolean InterfaceManagerImpl::onLoopStarted(gpointer data)
+{
+    ((InterfaceManagerImpl*)data)->handleLoopStarted();
+    return G_SOURCE_REMOVE;
+}
+
+void InterfaceManagerImpl::handleLoopStarted()
+{
+    boost::mutex::scoped_lock lock(mLoopMutex);
+
+    if(mStopEpoch >= mRunEpoch){
+        g_main_loop_quit(mLoop);
+    }
+    else{
+        mListening = true;
+    }
+}
+
+void InterfaceManagerImpl::onNetManagerSignal(GDBusConnection*, const gchar*, const gchar*,
+                                              const gchar*, const gchar* signal, GVariant* params, gpointer data)
 {
     /**< where data is a pointer to the instance of InterfaceManagerImpl */
     if(data != nullptr)
@@ -73,42 +131,46 @@ void InterfaceManagerImpl::onNetManagerSignal(GDBusProxy *proxy, gchar *sender,
 
 void InterfaceManagerImpl::handleNetManagerSignal(const std::string &signalName, GVariant *params)
 {
+     TRACE_SPAN("InterfaceManagerImpl::handleNetManagerSignal");
      unique_lock lock(mMutex);
+     const char *devPath = nullptr;
 
      try
      {             
          if(signalName == NM_SIGNAL_DEVICE_ADDED || signalName == NM_SIGNAL_DEVICE_REMOVED )
          {
-             const char *devPath;
              g_variant_get_child (params, 0, "&o", &devPath);
 
              if(signalName == NM_SIGNAL_DEVICE_ADDED)
              {
                  InterfaceInfo info = getDeviceInfo(devPath);
-                 mInterfaces.insert(InterfaceInfoPair(devPath, info));
-                 interfaceListUpdateSignal(info, true);
+                 stampUpdate(info, true);
+                 mInterfaces.insert(InterfaceInfoPair(info.id, info));
+                 reportUpdate(info, true);
              }
              else if(signalName == NM_SIGNAL_DEVICE_REMOVED)
              {
 
-                 auto info = mInterfaces.find(devPath);
-                 if(info != mInterfaces.end())
-                 {
-                     InterfaceInfo devInfo = info->second;
-                     mInterfaces.erase(devPath);
-                     interfaceListUpdateSignal(devInfo, false);
-                 }
+                 reportRemoval(devPath);
              }
          }
      }
-     catch(const std::exception& e){
-         updateFailedSignal();
+     catch(const std::exception& e)
+     {
+         /**< A device that could not be read is reread later instead of failing the whole backend */
+         if(devPath != nullptr){
+             skipUpdate(devPath);
+         }
+         else{
+             reportUpdateFailed();
+         }
      }
 }
 
 void InterfaceManagerImpl::updateDevices()
 {
-    unique_lock(mMutex);
+    TRACE_SPAN("InterfaceManagerImpl::updateDevices");
+    unique_lock lock(mMutex);
 
     GVariant* deviceList = nullptr;
     GError* error = nullptr;
@@ -116,17 +178,24 @@ void InterfaceManagerImpl::updateDevices()
 
     try
     {
-        if(mNetManagerProxy == nullptr){
-            throw std::runtime_error("Network Manager proxy not initialized");
+        if(mConnection == nullptr){
+            throw std::runtime_error("System bus connection not initialized");
         }
 
-        deviceList = g_dbus_proxy_call_sync(mNetManagerProxy,
-                                            NM_METHOD_GET_DEVICES,
-                                            NULL,
-                                            G_DBUS_CALL_FLAGS_NONE,
-                                            1000, //timout of operation
-                                            c,
-                                            &error);
+        {
+            TRACE_SPAN("GetDevices");
+            deviceList = g_dbus_connection_call_sync(mConnection,
+                                                     NM_IFACE_NETWORKMANAGER,
+                                                     NM_IFACE_NETWORKMANAGER_PATH,
+                                                     NM_IFACE_NETWORKMANAGER,
+                                                     NM_METHOD_GET_DEVICES,
+                                                     NULL,
+                                                     G_VARIANT_TYPE("(ao)"),
+                                                     G_DBUS_CALL_FLAGS_NONE,
+                                                     DBUS_CALL_TIMEOUT_MSEC,
+                                                     c,
+                                                     &error);
+        }
 
 
         if (deviceList == NULL && error != NULL){
@@ -146,7 +215,10 @@ void InterfaceManagerImpl::updateDevices()
                 gsize strlength = 256;
                 const gchar* devicePath = g_variant_get_string(deviceNode2, &strlength);
                 InterfaceInfo info = getDeviceInfo(devicePath);
-                mInterfaces.insert(InterfaceInfoPair(devicePath, info));
+                auto stored = mInterfaces.insert(InterfaceInfoPair(devicePath, info));
+                if(stored.second){
+                    stampEntry(stored.first->second);
+                }
             }
         }                
     }
@@ -165,144 +237,174 @@ void InterfaceManagerImpl::updateDevices()
         }
 
         std::cout<<e.what()<<std::endl;
-        updateFailedSignal();
+        reportUpdateFailed();
     }
 }
 
-InterfaceInfo InterfaceManagerImpl::getDeviceInfo(const std::string& deviceAddr)
+bool InterfaceManagerImpl::updateDevice(const std::string& deviceId)
 {
-    GDBusProxy* nmDeviceProxy = nullptr;
-    GError* error = nullptr;
+    TRACE_SPAN("InterfaceManagerImpl::updateDevice");
     InterfaceInfo info;
 
-    try
-    {              
-        nmDeviceProxy = g_dbus_proxy_new_for_bus_sync(G_BUS_TYPE_SYSTEM,
-                                                      G_DBUS_PROXY_FLAGS_NONE,
-                                                      NULL,
-                                                      NM_IFACE_NETWORKMANAGER,
-                                                      deviceAddr.c_str(),
-                                                      NM_IFACE_DEVICE,
-                                                      NULL,
-                                                      &error);
-
-
-        if (nmDeviceProxy == NULL && error != NULL){
-            throw std::runtime_error(error->message);
-        }      
+    try{
+        info = getDeviceInfo(deviceId);
+    }
+    catch(const DeviceRemovedError& e)
+    {
+        /**< A vanished device is up to date once its removal has been reported */
+        unique_lock lock(mMutex);
+        reportRemoval(deviceId);
 
-        guint deviceType = getDeviceType(nmDeviceProxy);
+        return true;
+    }
+    catch(const std::exception& e){
+        return false;
+    }
 
-        info.type = nmDevTypeToLocalDevType(deviceType);
-        info.name = getDeviceName(nmDeviceProxy);
+    unique_lock lock(mMutex);
 
-        const std::string nmModule = getNmInterface(deviceType);
-        if(nmModule.length()){
-            info.hwAddr = getDeviceHwAddress(deviceAddr, nmModule);
-        }     
+    auto stored = mInterfaces.find(deviceId);
+    if(stored == mInterfaces.end())
+    {
+        stampUpdate(info, true);
+        mInterfaces.insert(InterfaceInfoPair(deviceId, info));
+        reportUpdate(info, true);
     }
-    catch(...)
+    else if(stored->second.name != info.name ||
+            stored->second.hwAddr != info.hwAddr ||
+            stored->second.type != info.type)
     {
-        if(nmDeviceProxy != nullptr){
-            g_object_unref(nmDeviceProxy);
-        }
+        InterfaceInfo oldInfo = stored->second;
+        stampUpdate(oldInfo, false);
+        stampUpdate(info, true);
+        stored->second = info;
 
-        if(error != nullptr){
-            g_error_free(error);
-        }
+        reportUpdate(oldInfo, false);
+        reportUpdate(info, true);
+    }
 
-        throw;
+    return true;
+}
+
+void InterfaceManagerImpl::reportRemoval(const std::string& deviceId)
+{
+    auto info = mInterfaces.find(deviceId);
+    if(info != mInterfaces.end())
+    {
+        InterfaceInfo devInfo = std::move(info->second);
+        mInterfaces.erase(info);
+        stampUpdate(devInfo, false);
+        reportUpdate(devInfo, false);
     }
+}
+
+InterfaceInfo InterfaceManagerImpl::getDeviceInfo(const std::string& deviceAddr)
+{
+    TRACE_SPAN("InterfaceManagerImpl::getDeviceInfo");
+    InterfaceInfo info;
+
+    guint deviceType = getDeviceType(deviceAddr);
+
+    info.id = deviceAddr;
+    info.type = nmDevTypeToLocalDevType(deviceType);
+    info.name = getDeviceName(deviceAddr);
+
+    const std::string nmModule = getNmInterface(deviceType);
+    if(nmModule.length()){
+        info.hwAddr = getDeviceHwAddress(deviceAddr, nmModule);
+    }     
 
     return info;
 }
 
-std::string InterfaceManagerImpl::getDeviceName(GDBusProxy* proxy) const
+std::string InterfaceManagerImpl::getDeviceName(const std::string& deviceAddr) const
 {
-    std::string deviceName;
-    gsize strlength = 256;
+    GVariant* variant = getDeviceProperty(deviceAddr, NM_IFACE_DEVICE, NM_IFACE_DEVICE_PROPERTY_NAME);
 
-    GVariant* variant = g_dbus_proxy_get_cached_property(proxy, NM_IFACE_DEVICE_PROPERTY_NAME);
-    if (variant != nullptr)
+    if(!g_variant_is_of_type(variant, G_VARIANT_TYPE_STRING))
     {
-        deviceName = g_variant_get_string(variant, &strlength);
         g_variant_unref(variant);
-    }
-    else{
         throw std::runtime_error("Error reading device name");
     }
 
+    std::string deviceName = g_variant_get_string(variant, nullptr);
+    g_variant_unref(variant);
+
     return deviceName;
 }
 
-guint InterfaceManagerImpl::getDeviceType(GDBusProxy* proxy) const
+guint InterfaceManagerImpl::getDeviceType(const std::string& deviceAddr) const
 {
-    guint deviceType = NM_DEVICE_TYPE_UNKNOWN;
-    GVariant* variant = g_dbus_proxy_get_cached_property(proxy, NM_IFACE_DEVICE_PROPERTY_TYPE);
+    GVariant* variant = getDeviceProperty(deviceAddr, NM_IFACE_DEVICE, NM_IFACE_DEVICE_PROPERTY_TYPE);
 
-    if (variant != nullptr)
+    if(!g_variant_is_of_type(variant, G_VARIANT_TYPE_UINT32))
     {
-        deviceType = g_variant_get_uint32(variant);
         g_variant_unref(variant);
-    }
-    else{
         throw std::runtime_error("Error reading device type");
     }
 
+    guint deviceType = g_variant_get_uint32(variant);
+    g_variant_unref(variant);
+
     return deviceType;
 }
 
 std::string InterfaceManagerImpl::getDeviceHwAddress(const std::string& deviceAddr, const std::string& nmModuleName) const
 {
-    std::string hwAddress;
+    TRACE_SPAN("InterfaceManagerImpl::getDeviceHwAddress");
+    GVariant* variant = getDeviceProperty(deviceAddr, nmModuleName.c_str(), NM_IFACE_DEVICE_PROPERTY_HWADDR);
 
-    GError* error = nullptr;
-    GDBusProxy* ethProxy = nullptr;
-
-    try
+    if(!g_variant_is_of_type(variant, G_VARIANT_TYPE_STRING))
     {
-        ethProxy = g_dbus_proxy_new_for_bus_sync(G_BUS_TYPE_SYSTEM,
-                                                 G_DBUS_PROXY_FLAGS_NONE,
-                                                 NULL,
-                                                 NM_IFACE_NETWORKMANAGER,
-                                                 deviceAddr.c_str(),
-                                                 nmModuleName.c_str(),
-                                                 NULL,
-                                                 &error);
-
-        if (ethProxy == nullptr || error != nullptr){
-            throw std::runtime_error("Failed to init proxy");
-        }
-
-        GVariant* variant = g_dbus_proxy_get_cached_property(ethProxy, NM_IFACE_DEVICE_PROPERTY_HWADDR);
-        if (variant != nullptr)
-        {
-            gsize strLength = 255;
-            hwAddress = g_variant_get_string(variant, &strLength);
-            g_variant_unref(variant);
-        }
-        else{
-            throw std::runtime_error("Failed to get hw addr");
-        }
+        g_variant_unref(variant);
+        throw std::runtime_error("Failed to get hw addr");
     }
-    catch(const std::exception& e)
+
+    std::string hwAddress = g_variant_get_string(variant, nullptr);
+    g_variant_unref(variant);
+
+    return hwAddress;
+}
+
+GVariant* InterfaceManagerImpl::getDeviceProperty(const std::string& deviceAddr, const char* interface, const char* property) const
+{
+    GError* error = nullptr;
+    GVariant* reply = g_dbus_connection_call_sync(mConnection,
+                                                  NM_IFACE_NETWORKMANAGER,
+                                                  deviceAddr.c_str(),
+                                                  DBUS_IFACE_PROPERTIES,
+                                                  DBUS_METHOD_GET,
+                                                  g_variant_new("(ss)", interface, property),
+                                                  G_VARIANT_TYPE("(v)"),
+                                                  G_DBUS_CALL_FLAGS_NONE,
+                                                  DBUS_CALL_TIMEOUT_MSEC,
+                                                  NULL,
+                                                  &error);
+
+    if(reply == nullptr)
     {
-        std::string errorText = e.what();
+        std::string errorText = error != nullptr? error->message : "Error reading a device property";
 
-        if(error != nullptr)
-        {
-            errorText = error->message;
+        /**< The object of a removed device is gone, other errors may pass on a retry */
+        bool removed = g_error_matches(error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_OBJECT) ||
+                       g_error_matches(error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD);
+
+        if(error != nullptr){
             g_error_free(error);
         }
 
-        if(ethProxy != nullptr){
-            g_error_free(error);
+        if(removed){
+            throw DeviceRemovedError(errorText);
         }
 
         throw std::runtime_error(errorText);
     }
 
-    return hwAddress;
+    GVariant* value = nullptr;
+    g_variant_get(reply, "(v)", &value);
+    g_variant_unref(reply);
+
+    return value;
 }
 
 InterfaceType InterfaceManagerImpl::nmDevTypeToLocalDevType(const guint &deviceType) const
@@ -338,8 +440,11 @@ std::string InterfaceManagerImpl::getNmInterface(const guint &deviceType) const
 
 InterfaceManagerImpl::~InterfaceManagerImpl()
 {   
-     if(mNetManagerProxy != nullptr){
-         g_object_unref (mNetManagerProxy);
+     if(mConnection != nullptr)
+     {
+         g_dbus_connection_signal_unsubscribe(mConnection, mDeviceAddedSubscription);
+         g_dbus_connection_signal_unsubscribe(mConnection, mDeviceRemovedSubscription);
+         g_object_unref (mConnection);
      }
 
      if(mLoop != nullptr)
@@ -7,6 +7,7 @@
 */
 
 #include <iostream>
+#include <stdexcept>
 #include "dbus/dbus.h"
 #include <dbus/dbus-glib.h>
 #include <gio/gio.h>
@@ -32,17 +33,27 @@ enum NmDeviceType
 #define NM_IFACE_DEVICE_PROPERTY_TYPE       "DeviceType"
 #define NM_IFACE_DEVICE_PROPERTY_HWADDR     "HwAddress"
 
-#define NM_SIGNAL_G_SIGNAL                  "g-signal"   /**< connecting to g-signal, we connect to all signals coming from a proxy */
 #define NM_SIGNAL_DEVICE_ADDED              "DeviceAdded"
 #define NM_SIGNAL_DEVICE_REMOVED            "DeviceRemoved"
 
 #define NM_METHOD_GET_DEVICES               "GetDevices"
 
+#define DBUS_IFACE_PROPERTIES               "org.freedesktop.DBus.Properties"
+#define DBUS_METHOD_GET                     "Get"
+#define DBUS_CALL_TIMEOUT_MSEC              1000
+
 ////////////////////////////////////////////////////////////
 ///////            InterfaceManagerImpl           //////////
 ////////////////////////////////////////////////////////////
 
-class InterfaceManagerImpl : public AbstractInterfaceManagerImpl
+/**
+* @class InterfaceManagerImpl
+* @brief Subscribes to DeviceAdded and DeviceRemoved only, so the bus does not wake
+*  the loop for other NetworkManager signals. Devices are read with single property
+*  calls instead of proxies, which would load and track all properties of a device
+*/
+
+class InterfaceManagerImpl final : public AbstractInterfaceManagerImpl
 {    
 public:
     InterfaceManagerImpl();
@@ -50,24 +61,45 @@ public:
 
     void startListening();
     void stopListening();
+    void prepareListening();
     void updateDevices();
+    bool updateDevice(const std::string& deviceId);
 
 private:       
-
-    static void onNetManagerSignal(GDBusProxy *proxy, gchar *sender, gchar* signal, GVariant* params, gpointer data);
+    /**< Thrown when NetworkManager no longer has the device object */
+    class DeviceRemovedError : public std::runtime_error
+    {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    static void onNetManagerSignal(GDBusConnection*, const gchar*, const gchar*,
+                                   const gchar*, const gchar* signal, GVariant* params, gpointer data);
     void handleNetManagerSignal(const std::string& signalName, GVariant* params);
+    static gboolean onLoopStarted(gpointer data);
+    void handleLoopStarted();
+    guint subscribe(const char* signalName);
 
     InterfaceInfo getDeviceInfo(const std::string& deviceAddr);
-    guint getDeviceType(GDBusProxy* proxy) const;
-    std::string getDeviceName(GDBusProxy* proxy) const;
+    guint getDeviceType(const std::string& deviceAddr) const;
+    std::string getDeviceName(const std::string& deviceAddr) const;
     std::string getDeviceHwAddress(const std::string& deviceAddr, const std::string& nmModuleName) const;
+    GVariant* getDeviceProperty(const std::string& deviceAddr, const char* interface, const char* property) const;   /**< The caller unrefs the value */
+    void reportRemoval(const std::string& deviceId);    /**< Expects mMutex to be locked */
 
     InterfaceType nmDevTypeToLocalDevType(const guint& deviceType) const;
     std::string getNmInterface(const guint& deviceType) const;  /**< The name of an interface responsible for the device type */
 
 private:     
     GMainLoop *mLoop;    /**< GLib's event loop is required to get their signal system working */
-    GDBusProxy* mNetManagerProxy;  
+    bool mListening;                /**< Set once the loop is running, so quitting it is guaranteed to stop it */
+    uint64_t mStartEpoch;           /**< Starts prepared or begun so far */
+    uint64_t mRunEpoch;             /**< Starts begun so far, the current or last run */
+    uint64_t mStopEpoch;            /**< Runs up to this one are stopped, stops never reach later starts */
+    boost::mutex mLoopMutex;
+    GDBusConnection* mConnection;
+    guint mDeviceAddedSubscription;
+    guint mDeviceRemovedSubscription;
 };
 
 #endif // INTERFACEMANAGERIMPLLINUX_H
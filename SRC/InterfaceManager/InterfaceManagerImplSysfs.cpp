@@ -0,0 +1,405 @@
+#include "InterfaceManagerImplSysfs.h"
+#include "Tracer.h"
+
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <ctype.h>
+#include <errno.h>
+
+#include <boost/chrono.hpp>
+
+namespace
+{
+    /**< FNV-1a */
+    uint64_t hashAttribute(const char* value)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for(; *value; ++value)
+        {
+            hash ^= static_cast<unsigned char>(*value);
+            hash *= 1099511628211ULL;
+        }
+
+        return hash;
+    }
+
+    /**< The DEVTYPE value of a uevent file, empty for plain devices */
+    std::string getDevType(const char* uevent)
+    {
+        const char* devType = strstr(uevent, SYSFS_UEVENT_DEVTYPE);
+        if(devType == nullptr){
+            return std::string();
+        }
+
+        devType += strlen(SYSFS_UEVENT_DEVTYPE);
+        return std::string(devType, strcspn(devType, "\n"));
+    }
+}
+
+////////////////////////////////////////////////////////////
+///////         SysfsInterfaceManagerImpl         //////////
+////////////////////////////////////////////////////////////
+
+SysfsInterfaceManagerImpl::SysfsInterfaceManagerImpl(const std::string& path, const uint32_t& pollPeriodMsec) :
+    mPath(path),
+    mDir(nullptr),
+    mPollPeriodMsec(pollPeriodMsec),
+    mScan(0),
+    mCachedFds(0),
+    mStartEpoch(0),
+    mRunEpoch(0),
+    mStopEpoch(0)
+{
+    TRACE_SPAN("SysfsInterfaceManagerImpl::SysfsInterfaceManagerImpl");
+
+    mDir = opendir(mPath.c_str());
+    if(mDir == nullptr){
+        throw std::runtime_error("Error opening " + mPath);
+    }
+}
+
+void SysfsInterfaceManagerImpl::startListening()
+{
+    unique_lock lock(mMutex);
+
+    uint64_t epoch = ++mRunEpoch;
+    mStartEpoch = std::max(mStartEpoch, epoch);
+
+    /**< Interfaces present before listening are not reported, as with NetworkManager */
+    if(mScan == 0){
+        scan(false);
+    }
+
+    while(mStopEpoch < epoch)
+    {
+        mStopCondition.wait_for(lock, boost::chrono::milliseconds(mPollPeriodMsec));
+
+        if(mStopEpoch < epoch){
+            scan(true);
+        }
+    }
+}
+
+void SysfsInterfaceManagerImpl::stopListening()
+{
+    {
+        unique_lock lock(mMutex);
+        mStopEpoch = mStartEpoch;
+    }
+
+    mStopCondition.notify_all();
+}
+
+void SysfsInterfaceManagerImpl::prepareListening()
+{
+    unique_lock lock(mMutex);
+    ++mStartEpoch;
+}
+
+void SysfsInterfaceManagerImpl::updateDevices()
+{
+    TRACE_SPAN("SysfsInterfaceManagerImpl::updateDevices");
+    unique_lock lock(mMutex);
+    scan(false);
+}
+
+void SysfsInterfaceManagerImpl::poll()
+{
+    unique_lock lock(mMutex);
+    scan(true);
+}
+
+bool SysfsInterfaceManagerImpl::updateDevice(const std::string& deviceId)
+{
+    TRACE_SPAN("SysfsInterfaceManagerImpl::updateDevice");
+    unique_lock lock(mMutex);
+
+    if(deviceId.compare(0, mPath.size(), mPath) != 0 || deviceId.size() <= mPath.size() + 1){
+        return false;
+    }
+
+    const std::string name = deviceId.substr(mPath.size() + 1);
+
+    struct stat entry;
+    if(fstatat(dirfd(mDir), name.c_str(), &entry, AT_SYMLINK_NOFOLLOW) != 0)
+    {
+        /**< A vanished device is up to date once its removal has been reported */
+        bool vanished = errno == ENOENT;
+
+        auto device = mDevices.find(name);
+        if(vanished && device != mDevices.end()){
+            removeDevice(device, true);
+        }
+
+        return vanished;
+    }
+
+    auto device = mDevices.find(name);
+    if(device == mDevices.end() || device->second.inode != entry.st_ino)
+    {
+        if(device != mDevices.end()){
+            removeDevice(device, true);
+        }
+
+        return addDevice(name, entry.st_ino, true);
+    }
+
+    /**< The same netdev, only the address may have changed */
+    char address[SYSFS_ATTRIBUTE_SIZE];
+    if(!readAddress(name, device->second, address)){
+        return false;
+    }
+
+    if(hashAttribute(address) == device->second.hash){
+        return true;
+    }
+
+    InterfaceInfo oldInfo = device->second.info;
+    if(!readDevice(name, device->second)){
+        return false;
+    }
+
+    InterfaceInfo& info = device->second.info;
+    if(oldInfo.hwAddr != info.hwAddr || oldInfo.type != info.type)
+    {
+        stampUpdate(oldInfo, false);
+        stampUpdate(info, true);
+        mInterfaces[info.id] = info;
+
+        reportUpdate(oldInfo, false);
+        reportUpdate(info, true);
+    }
+
+    return true;
+}
+
+void SysfsInterfaceManagerImpl::scan(const bool& notify)
+{
+    TRACE_SPAN("SysfsInterfaceManagerImpl::scan");
+    ++mScan;
+
+    size_t present = 0;
+
+    rewinddir(mDir);
+    while(dirent* entry = readdir(mDir))
+    {
+        /**< Skips dot entries and files such as bonding_masters */
+        if(entry->d_type != DT_LNK && entry->d_type != DT_UNKNOWN){
+            continue;
+        }
+
+        auto device = mDevices.find(entry->d_name);
+        if(device != mDevices.end())
+        {
+            if(device->second.inode == entry->d_ino)
+            {
+                device->second.scan = mScan;
+                ++present;
+                continue;
+            }
+
+            /**< Registered again under the same name */
+            removeDevice(device, notify);
+        }
+
+        if(addDevice(entry->d_name, entry->d_ino, notify)){
+            ++present;
+        }
+    }
+
+    /**< Every stored device has been seen unless some have vanished */
+    if(present == mDevices.size()){
+        return;
+    }
+
+    for(auto device = mDevices.begin(); device != mDevices.end();)
+    {
+        if(device->second.scan != mScan){
+            device = removeDevice(device, notify);
+        }
+        else{
+            ++device;
+        }
+    }
+}
+
+bool SysfsInterfaceManagerImpl::addDevice(const std::string& name, const ino_t& inode, const bool& notify)
+{
+    Device device;
+    device.inode = inode;
+    device.addressFd = -1;
+    device.hash = 0;
+    device.scan = mScan;
+
+    /**< A device that vanished meanwhile is left for the next scan */
+    if(!readDevice(name, device))
+    {
+        closeDevice(device);
+        return false;
+    }
+
+    if(notify){
+        stampUpdate(device.info, true);
+    }
+    else{
+        stampEntry(device.info);
+    }
+
+    auto stored = mDevices.insert(std::make_pair(name, device)).first;
+    mInterfaces.insert(InterfaceInfoPair(stored->second.info.id, stored->second.info));
+
+    if(notify){
+        reportUpdate(stored->second.info, true);
+    }
+
+    return true;
+}
+
+SysfsInterfaceManagerImpl::DeviceStorage::iterator SysfsInterfaceManagerImpl::removeDevice(DeviceStorage::iterator device,
+                                                                                         const bool& notify)
+{
+    closeDevice(device->second);
+    mInterfaces.erase(device->second.info.id);
+
+    if(notify)
+    {
+        stampUpdate(device->second.info, false);
+        reportUpdate(device->second.info, false);
+    }
+
+    return mDevices.erase(device);
+}
+
+bool SysfsInterfaceManagerImpl::readDevice(const std::string& name, Device& device)
+{
+    char address[SYSFS_ATTRIBUTE_SIZE];
+    char type[SYSFS_ATTRIBUTE_SIZE];
+    char uevent[SYSFS_ATTRIBUTE_SIZE];
+
+    if(!readAttribute(name, SYSFS_ATTRIBUTE_TYPE, type)){
+        return false;
+    }
+
+    /**< Interfaces without an address such as tun may fail to read it */
+    if(!readAddress(name, device, address)){
+        address[0] = '\0';
+    }
+
+    if(!readAttribute(name, SYSFS_ATTRIBUTE_UEVENT, uevent)){
+        uevent[0] = '\0';
+    }
+
+    device.hash = hashAttribute(address);
+    device.info.id = mPath + "/" + name;
+    device.info.name = name;
+    device.info.type = sysfsTypeToLocalType(type, uevent);
+    device.info.hwAddr.clear();
+
+    /**< NetworkManager only reports the address of ethernet, wifi and vlan devices, in upper case */
+    if(device.info.type == IF_TYPE_ETH || device.info.type == IF_TYPE_TUN)
+    {
+        device.info.hwAddr.assign(address, strcspn(address, "\n"));
+        for(char& c : device.info.hwAddr){
+            c = toupper(c);
+        }
+    }
+
+    return true;
+}
+
+bool SysfsInterfaceManagerImpl::readAddress(const std::string& name, Device& device, char* buffer)
+{
+    if(device.addressFd < 0 && mCachedFds < SYSFS_MAX_CACHED_FDS)
+    {
+        device.addressFd = openAttribute(name, SYSFS_ATTRIBUTE_ADDRESS);
+        if(device.addressFd >= 0){
+            ++mCachedFds;
+        }
+    }
+
+    if(device.addressFd >= 0){
+        return readAttribute(device.addressFd, buffer);
+    }
+
+    return readAttribute(name, SYSFS_ATTRIBUTE_ADDRESS, buffer);
+}
+
+void SysfsInterfaceManagerImpl::closeDevice(Device& device)
+{
+    if(device.addressFd >= 0)
+    {
+        close(device.addressFd);
+        device.addressFd = -1;
+        --mCachedFds;
+    }
+}
+
+int SysfsInterfaceManagerImpl::openAttribute(const std::string& name, const char* attribute) const
+{
+    char path[SYSFS_ATTRIBUTE_SIZE];
+    snprintf(path, sizeof(path), "%s/%s", name.c_str(), attribute);
+
+    return openat(dirfd(mDir), path, O_RDONLY | O_CLOEXEC);
+}
+
+bool SysfsInterfaceManagerImpl::readAttribute(const int& fd, char* buffer) const
+{
+    /**< sysfs regenerates the contents on every read from offset 0 */
+    ssize_t size = pread(fd, buffer, SYSFS_ATTRIBUTE_SIZE - 1, 0);
+    if(size < 0){
+        return false;
+    }
+
+    buffer[size] = '\0';
+    return true;
+}
+
+bool SysfsInterfaceManagerImpl::readAttribute(const std::string& name, const char* attribute, char* buffer) const
+{
+    int fd = openAttribute(name, attribute);
+    if(fd < 0){
+        return false;
+    }
+
+    bool result = readAttribute(fd, buffer);
+    close(fd);
+
+    return result;
+}
+
+InterfaceType SysfsInterfaceManagerImpl::sysfsTypeToLocalType(const char* type, const char* uevent) const
+{
+    InterfaceType localType = IF_TYPE_UNKNOWN;
+    long arpType = strtol(type, nullptr, 10);
+
+    if(arpType == SYSFS_ARPHRD_LOOPBACK){
+        localType = IF_TYPE_LO;
+    }
+    else if(arpType == SYSFS_ARPHRD_ETHER)
+    {
+        /**< Bridges, bonds and the like are ethernet too, but NetworkManager does not report them as such */
+        const std::string devType = getDevType(uevent);
+
+        if(devType.empty() || devType == "wlan"){
+            localType = IF_TYPE_ETH;
+        }
+        else if(devType == "vlan"){
+            localType = IF_TYPE_TUN;
+        }
+    }
+
+    return localType;
+}
+
+SysfsInterfaceManagerImpl::~SysfsInterfaceManagerImpl()
+{
+    for(auto& device : mDevices){
+        closeDevice(device.second);
+    }
+
+    if(mDir != nullptr){
+        closedir(mDir);
+    }
+}
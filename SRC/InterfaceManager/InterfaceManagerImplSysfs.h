@@ -0,0 +1,100 @@
+#ifndef INTERFACEMANAGERIMPLSYSFS_H
+#define INTERFACEMANAGERIMPLSYSFS_H
+
+/**
+* @file InterfaceManagerImplSysfs.h
+* @brief Contains a linux implementation of InterfaceManager polling /sys/class/net,
+*  for hosts without NetworkManager
+*/
+
+#include <dirent.h>
+#include <sys/types.h>
+#include <unordered_map>
+
+#include <boost/thread/condition_variable.hpp>
+
+#include "AbstractInterfaceManagerImpl.h"
+
+#define SYSFS_NET_PATH                  "/sys/class/net"
+#define SYSFS_POLL_PERIOD_MSEC          1000
+#define SYSFS_MAX_CACHED_FDS            512     /**< Stays well below the default RLIMIT_NOFILE */
+#define SYSFS_ATTRIBUTE_SIZE            256
+
+#define SYSFS_ATTRIBUTE_ADDRESS         "address"
+#define SYSFS_ATTRIBUTE_TYPE            "type"
+#define SYSFS_ATTRIBUTE_UEVENT          "uevent"
+#define SYSFS_UEVENT_DEVTYPE            "DEVTYPE="
+
+#define SYSFS_ARPHRD_ETHER              1
+#define SYSFS_ARPHRD_LOOPBACK           772
+
+////////////////////////////////////////////////////////////
+///////         SysfsInterfaceManagerImpl         //////////
+////////////////////////////////////////////////////////////
+
+/**
+* @class SysfsInterfaceManagerImpl
+* @brief Scans the class directory through a single cached handle. Every interface
+*  is a link whose inode changes when a netdev is registered again, so an entry
+*  with a known name and inode is skipped without reading its attributes.
+*  Device ids are the interface paths, e.g. /sys/class/net/eth0. Types and addresses
+*  are reported the same way as by the NetworkManager backend
+*/
+
+class SysfsInterfaceManagerImpl final : public AbstractInterfaceManagerImpl
+{
+private:
+    struct Device
+    {
+        ino_t inode;                /**< Of the class directory entry */
+        int addressFd;              /**< Cached for rereads, -1 when over the limit */
+        uint64_t hash;              /**< Of the attribute contents the info was made from */
+        uint64_t scan;              /**< The last scan the entry was seen in */
+        InterfaceInfo info;
+    };
+
+    typedef std::unordered_map<std::string, Device> DeviceStorage;  /**< By interface name */
+
+public:
+    SysfsInterfaceManagerImpl(const std::string& path = SYSFS_NET_PATH,
+                              const uint32_t& pollPeriodMsec = SYSFS_POLL_PERIOD_MSEC);
+    ~SysfsInterfaceManagerImpl();
+
+    void startListening();          /**< Polls until stopListening is called */
+    void stopListening();
+    void prepareListening();
+    void updateDevices();           /**< Scans without reporting, like a fresh device list */
+    bool updateDevice(const std::string& deviceId);
+
+    void poll();                    /**< Scans once and reports added and removed interfaces */
+
+private:
+    void scan(const bool& notify);
+
+    bool addDevice(const std::string& name, const ino_t& inode, const bool& notify);
+    DeviceStorage::iterator removeDevice(DeviceStorage::iterator device, const bool& notify);
+
+    bool readDevice(const std::string& name, Device& device);   /**< Fills the info, returns false if unreadable */
+    bool readAddress(const std::string& name, Device& device, char* buffer);
+    void closeDevice(Device& device);
+
+    int openAttribute(const std::string& name, const char* attribute) const;
+    bool readAttribute(const int& fd, char* buffer) const;
+    bool readAttribute(const std::string& name, const char* attribute, char* buffer) const;
+
+    InterfaceType sysfsTypeToLocalType(const char* type, const char* uevent) const;
+
+private:
+    std::string mPath;
+    DIR* mDir;
+    uint32_t mPollPeriodMsec;
+    DeviceStorage mDevices;
+    uint64_t mScan;
+    size_t mCachedFds;
+    uint64_t mStartEpoch;           /**< Starts prepared or begun so far */
+    uint64_t mRunEpoch;             /**< Starts begun so far */
+    uint64_t mStopEpoch;            /**< Runs up to this one are stopped, stops never reach later starts */
+    boost::condition_variable mStopCondition;
+};
+
+#endif // INTERFACEMANAGERIMPLSYSFS_H
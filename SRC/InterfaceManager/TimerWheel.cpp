@@ -0,0 +1,236 @@
+#include "TimerWheel.h"
+
+#include <limits>
+
+////////////////////////////////////////////////////////////
+///////               TimerWheel                  //////////
+////////////////////////////////////////////////////////////
+
+TimerWheel::TimerWheel(boost::asio::io_service& io, const uint32_t& tickMsec) :
+    mTimer(io),
+    mStartTime(boost::posix_time::microsec_clock::universal_time()),
+    mTickMsec(std::max<uint32_t>(tickMsec, 1)),
+    mCurrentTick(0),
+    mArmedTick(0),
+    mNextId(1),
+    mTimerRunning(false)
+{
+
+}
+
+TimerId TimerWheel::schedule(const uint32_t& delayMsec, const TimerCallback& callback)
+{
+    boost::mutex::scoped_lock lock(mMutex);
+
+    /**< An empty wheel has nothing to cascade, so it may skip the idle ticks */
+    uint64_t now = getCurrentTick();
+    if(mTasks.empty()){
+        mCurrentTick = now;
+    }
+
+    Task task;
+    task.id = mNextId++;
+    task.expiry = std::max(now + (delayMsec + mTickMsec - 1) / mTickMsec, mCurrentTick);
+    task.callback = callback;
+
+    Slot pending;
+    Slot::iterator it = pending.insert(pending.end(), task);
+    mTasks[task.id] = TaskPosition{&pending, it};
+    insert(pending, it);
+
+    /**< Tasks due before the armed tick move the timer forward */
+    if(!mTimerRunning || task.expiry < mArmedTick){
+        startTimer(findNextTick());
+    }
+
+    return task.id;
+}
+
+bool TimerWheel::cancel(const TimerId& id)
+{
+    boost::mutex::scoped_lock lock(mMutex);
+
+    auto position = mTasks.find(id);
+    if(position == mTasks.end()){
+        return false;
+    }
+
+    position->second.slot->erase(position->second.task);
+    mTasks.erase(position);
+
+    return true;
+}
+
+void TimerWheel::clear()
+{
+    boost::mutex::scoped_lock lock(mMutex);
+
+    for(auto& level : mLevels)
+    {
+        for(auto& slot : level){
+            slot.clear();
+        }
+    }
+
+    mOverflow.clear();
+    mTasks.clear();
+}
+
+size_t TimerWheel::size() const
+{
+    boost::mutex::scoped_lock lock(mMutex);
+    return mTasks.size();
+}
+
+void TimerWheel::insert(Slot& source, const Slot::iterator& task)
+{
+    uint64_t delta = task->expiry > mCurrentTick? task->expiry - mCurrentTick : 0;
+    uint64_t expiry = mCurrentTick + delta;
+    Slot* dest = &mOverflow;
+
+    for(uint32_t level = 0; level < TIMER_WHEEL_LEVELS; ++level)
+    {
+        if(delta < (uint64_t(1) << (TIMER_WHEEL_LEVEL_BITS * (level + 1))))
+        {
+            dest = &mLevels[level][(expiry >> (TIMER_WHEEL_LEVEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1)];
+            break;
+        }
+    }
+
+    /**< Splicing keeps the iterator in mTasks valid */
+    dest->splice(dest->end(), source, task);
+    mTasks[task->id].slot = dest;
+}
+
+void TimerWheel::startTimer(const uint64_t& tick)
+{
+    /**< Rearming a running timer aborts its pending wait */
+    mTimerRunning = true;
+    mArmedTick = tick;
+    mTimer.expires_at(mStartTime + boost::posix_time::milliseconds(tick * mTickMsec));
+    mTimer.async_wait(boost::bind(&TimerWheel::onTick, this, boost::asio::placeholders::error));
+}
+
+uint64_t TimerWheel::findNextTick() const
+{
+    uint64_t next = std::numeric_limits<uint64_t>::max();
+
+    /**< The first level holds tasks of the next TIMER_WHEEL_SLOTS ticks only */
+    for(uint64_t tick = mCurrentTick; tick < mCurrentTick + TIMER_WHEEL_SLOTS; ++tick)
+    {
+        if(!mLevels[0][tick & (TIMER_WHEEL_SLOTS - 1)].empty())
+        {
+            next = tick;
+            break;
+        }
+    }
+
+    /**< Cascades due before that tick must not be stepped over.
+     *   A higher level slot is cascaded at the first multiple of its level span with a matching index */
+    for(uint32_t level = 1; level < TIMER_WHEEL_LEVELS; ++level)
+    {
+        uint32_t shift = TIMER_WHEEL_LEVEL_BITS * level;
+        uint64_t block = (mCurrentTick + (uint64_t(1) << shift) - 1) >> shift;
+
+        for(uint64_t index = 0; index < TIMER_WHEEL_SLOTS; ++index)
+        {
+            if(!mLevels[level][index].empty())
+            {
+                uint64_t tick = (block + ((index - block) & (TIMER_WHEEL_SLOTS - 1))) << shift;
+                next = std::min(next, tick);
+            }
+        }
+    }
+
+    /**< Overflowing tasks are reinserted together with the top level */
+    if(!mOverflow.empty())
+    {
+        uint32_t shift = TIMER_WHEEL_LEVEL_BITS * (TIMER_WHEEL_LEVELS - 1);
+        next = std::min(next, ((mCurrentTick + (uint64_t(1) << shift) - 1) >> shift) << shift);
+    }
+
+    return next;
+}
+
+void TimerWheel::onTick(const boost::system::error_code& ec)
+{
+    if(ec == boost::asio::error::operation_aborted){
+        return;
+    }
+
+    std::vector<TimerCallback> expired;
+
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+
+        uint64_t now = getCurrentTick();
+
+        /**< Ticks without tasks to expire or cascade are skipped */
+        while(!mTasks.empty())
+        {
+            uint64_t next = findNextTick();
+            if(next > now){
+                break;
+            }
+
+            mCurrentTick = next;
+
+            /**< Moving the tasks of the current higher level slots one level down */
+            for(uint32_t level = 1; level < TIMER_WHEEL_LEVELS; ++level)
+            {
+                uint32_t shift = TIMER_WHEEL_LEVEL_BITS * level;
+                if(mCurrentTick & ((uint64_t(1) << shift) - 1)){
+                    break;
+                }
+
+                Slot& slot = mLevels[level][(mCurrentTick >> shift) & (TIMER_WHEEL_SLOTS - 1)];
+                while(!slot.empty()){
+                    insert(slot, slot.begin());
+                }
+
+                if(level == TIMER_WHEEL_LEVELS - 1)
+                {
+                    while(!mOverflow.empty()){
+                        insert(mOverflow, mOverflow.begin());
+                    }
+                }
+            }
+
+            Slot& current = mLevels[0][mCurrentTick & (TIMER_WHEEL_SLOTS - 1)];
+            for(auto& task : current)
+            {
+                expired.push_back(task.callback);
+                mTasks.erase(task.id);
+            }
+
+            current.clear();
+            ++mCurrentTick;
+        }
+
+        if(mTasks.empty()){
+            mTimerRunning = false;
+        }
+        else{
+            startTimer(findNextTick());
+        }
+    }
+
+    /**< Callbacks are free to schedule new tasks */
+    for(auto& callback : expired){
+        callback();
+    }
+}
+
+uint64_t TimerWheel::getCurrentTick() const
+{
+    boost::posix_time::time_duration elapsed = boost::posix_time::microsec_clock::universal_time() - mStartTime;
+    return elapsed.total_milliseconds() / mTickMsec;
+}
+
+TimerWheel::~TimerWheel()
+{
+    clear();
+
+    boost::system::error_code ec;
+    mTimer.cancel(ec);
+}
@@ -0,0 +1,90 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+/**
+* @file TimerWheel.h
+* @brief Contains a hierarchical timer wheel driven by a single asio timer.
+*  Scheduling and cancelling are O(1), so per-interface tasks scale
+*  to tens of thousands of interfaces. The timer is only armed for ticks
+*  that expire tasks or cascade them, an idle wheel does not wake up
+*/
+
+#include <list>
+#include <unordered_map>
+#include <functional>
+#include <stdint.h>
+
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#define TIMER_WHEEL_TICK_MSEC       10
+#define TIMER_WHEEL_LEVEL_BITS      6
+#define TIMER_WHEEL_SLOTS           (1 << TIMER_WHEEL_LEVEL_BITS)
+#define TIMER_WHEEL_LEVELS          4          /**< 64^4 ticks, about 1.9 days with 10ms ticks */
+
+typedef uint64_t TimerId;
+typedef std::function<void ()> TimerCallback;
+
+////////////////////////////////////////////////////////////
+///////               TimerWheel                  //////////
+////////////////////////////////////////////////////////////
+
+/**
+* @class TimerWheel
+* @brief Tasks are put into the slot of the level matching their distance from now
+*  and cascade down to lower levels as time goes. Callbacks are run on the event loop
+*  without the wheel lock held, so they may schedule and cancel tasks
+*/
+
+class TimerWheel
+{
+private:
+    struct Task
+    {
+        TimerId id;
+        uint64_t expiry;                          /**< In ticks */
+        TimerCallback callback;
+    };
+
+    typedef std::list<Task> Slot;
+
+    struct TaskPosition
+    {
+        Slot* slot;
+        Slot::iterator task;
+    };
+
+private:
+    void insert(Slot& source, const Slot::iterator& task);   /**< Moves the task into the slot matching its expiry */
+    void startTimer(const uint64_t& tick);
+    void onTick(const boost::system::error_code& ec);
+    uint64_t getCurrentTick() const;
+    uint64_t findNextTick() const;              /**< The first tick from mCurrentTick on with tasks to expire or cascade, whichever comes first */
+
+public:
+    TimerWheel(boost::asio::io_service& io, const uint32_t& tickMsec = TIMER_WHEEL_TICK_MSEC);
+    ~TimerWheel();
+
+    TimerId schedule(const uint32_t& delayMsec, const TimerCallback& callback);
+    bool cancel(const TimerId& id);               /**< Returns false if the task has already run */
+    void clear();
+    size_t size() const;
+
+private:
+    mutable boost::mutex mMutex;
+    boost::asio::deadline_timer mTimer;
+    boost::posix_time::ptime mStartTime;
+    uint32_t mTickMsec;
+    uint64_t mCurrentTick;                        /**< All ticks before this one have been processed */
+    uint64_t mArmedTick;                          /**< The timer expires at this tick while it is running */
+    TimerId mNextId;
+    bool mTimerRunning;
+
+    Slot mLevels[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    Slot mOverflow;                               /**< Tasks too far in the future for the top level */
+    std::unordered_map<TimerId, TaskPosition> mTasks;
+};
+
+#endif // TIMERWHEEL_H
@@ -0,0 +1,145 @@
+#include "Tracer.h"
+
+#include <fstream>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+std::atomic<bool> Tracer::sEnabled(false);
+
+////////////////////////////////////////////////////////////
+///////                 Tracer                    //////////
+////////////////////////////////////////////////////////////
+
+Tracer::Tracer()
+{
+
+}
+
+Tracer& Tracer::instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+uint64_t Tracer::now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+void Tracer::enable(const std::string& outputPath)
+{
+    boost::mutex::scoped_lock lock(mMutex);
+
+    mOutputPath = outputPath;
+    sEnabled.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::enableFromEnvironment()
+{
+    const char* outputPath = getenv(TRACE_ENV_VARIABLE);
+
+    if(outputPath != nullptr && *outputPath != '\0'){
+        enable(outputPath);
+    }
+}
+
+void Tracer::disable()
+{
+    sEnabled.store(false, std::memory_order_relaxed);
+}
+
+Tracer::TraceBuffer* Tracer::getThreadBuffer()
+{
+    /**< Buffers are owned by the tracer, so spans of finished threads are still dumped */
+    static thread_local TraceBuffer* threadBuffer = nullptr;
+
+    if(threadBuffer == nullptr)
+    {
+        std::unique_ptr<TraceBuffer> buffer(new TraceBuffer);
+        buffer->threadId = syscall(SYS_gettid);
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->dropped.store(0, std::memory_order_relaxed);
+
+        boost::mutex::scoped_lock lock(mMutex);
+        threadBuffer = buffer.get();
+        mBuffers.push_back(std::move(buffer));
+    }
+
+    return threadBuffer;
+}
+
+void Tracer::record(const char* name, const uint64_t& beginUsec, const uint64_t& endUsec)
+{
+    TraceBuffer* buffer = getThreadBuffer();
+    uint32_t count = buffer->count.load(std::memory_order_relaxed);
+
+    if(count >= TRACE_BUFFER_EVENTS)
+    {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    TraceEvent& event = buffer->events[count];
+    event.name = name;
+    event.beginUsec = beginUsec;
+    event.endUsec = endUsec;
+
+    buffer->count.store(count + 1, std::memory_order_release);
+}
+
+bool Tracer::dump()
+{
+    boost::mutex::scoped_lock lock(mMutex);
+
+    if(mOutputPath.empty()){
+        return false;
+    }
+
+    std::ofstream output(mOutputPath.c_str(), std::ios::trunc);
+    if(!output){
+        return false;
+    }
+
+    pid_t pid = getpid();
+    bool first = true;
+
+    output<<"{\"traceEvents\":[";
+
+    for(auto& buffer : mBuffers)
+    {
+        uint32_t count = buffer->count.load(std::memory_order_acquire);
+
+        for(uint32_t i = 0; i < count; ++i)
+        {
+            const TraceEvent& event = buffer->events[i];
+
+            output<<(first? "\n" : ",\n")
+                  <<"{\"name\":\""<<event.name<<"\",\"ph\":\"X\""
+                  <<",\"ts\":"<<event.beginUsec
+                  <<",\"dur\":"<<event.endUsec - event.beginUsec
+                  <<",\"pid\":"<<pid
+                  <<",\"tid\":"<<buffer->threadId<<"}";
+
+            first = false;
+        }
+
+        uint32_t dropped = buffer->dropped.load(std::memory_order_relaxed);
+        if(dropped)
+        {
+            output<<(first? "\n" : ",\n")
+                  <<"{\"name\":\"dropped spans\",\"ph\":\"C\",\"ts\":"<<now()
+                  <<",\"pid\":"<<pid<<",\"tid\":"<<buffer->threadId
+                  <<",\"args\":{\"count\":"<<dropped<<"}}";
+
+            first = false;
+        }
+    }
+
+    output<<"\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    return output.good();
+}
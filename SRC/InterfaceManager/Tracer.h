@@ -0,0 +1,110 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+/**
+* @file Tracer.h
+* @brief Contains an optional tracer of internal spans (constructor, GetDevices,
+*  device info lookups, dumps...). Each thread records into its own buffer without locks,
+*  the collected spans are written as Chrome trace-event JSON (chrome://tracing, Perfetto).
+*  When tracing is disabled a span costs a single relaxed atomic load
+*/
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include <boost/thread/mutex.hpp>
+
+#define TRACE_BUFFER_EVENTS     16384       /**< Spans kept per thread, later ones are dropped */
+#define TRACE_ENV_VARIABLE      "IFMON_TRACE"
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b)      TRACE_CONCAT_IMPL(a, b)
+
+/**< Traces the enclosing scope. The name must be a string literal */
+#define TRACE_SPAN(name)        TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(name)
+
+////////////////////////////////////////////////////////////
+///////                 Tracer                    //////////
+////////////////////////////////////////////////////////////
+
+class Tracer
+{
+private:
+    struct TraceEvent
+    {
+        const char* name;
+        uint64_t beginUsec;
+        uint64_t endUsec;
+    };
+
+    /**< Written by its thread only, the count is published after the event */
+    struct TraceBuffer
+    {
+        uint64_t threadId;
+        std::atomic<uint32_t> count;
+        std::atomic<uint32_t> dropped;
+        TraceEvent events[TRACE_BUFFER_EVENTS];
+    };
+
+private:
+    Tracer();
+    TraceBuffer* getThreadBuffer();
+
+public:
+    static Tracer& instance();
+    static bool isEnabled();
+    static uint64_t now();                        /**< Monotonic time in usec */
+
+    void enable(const std::string& outputPath);
+    void enableFromEnvironment();                 /**< Enables tracing if TRACE_ENV_VARIABLE holds an output path */
+    void disable();
+    void record(const char* name, const uint64_t& beginUsec, const uint64_t& endUsec);
+    bool dump();                                  /**< Writes all recorded spans to the output path */
+
+private:
+    static std::atomic<bool> sEnabled;
+
+    boost::mutex mMutex;                          /**< Guards registration of buffers and the output path */
+    std::vector<std::unique_ptr<TraceBuffer>> mBuffers;
+    std::string mOutputPath;
+};
+
+////////////////////////////////////////////////////////////
+///////                TraceSpan                  //////////
+////////////////////////////////////////////////////////////
+
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char* name) :
+        mName(Tracer::isEnabled()? name : nullptr),
+        mBeginUsec(mName != nullptr? Tracer::now() : 0)
+    {
+
+    }
+
+    ~TraceSpan()
+    {
+        if(mName != nullptr){
+            Tracer::instance().record(mName, mBeginUsec, Tracer::now());
+        }
+    }
+
+private:
+    TraceSpan(const TraceSpan&);
+    TraceSpan& operator=(const TraceSpan&);
+
+private:
+    const char* mName;
+    uint64_t mBeginUsec;
+};
+
+inline bool Tracer::isEnabled()
+{
+    return sEnabled.load(std::memory_order_relaxed);
+}
+
+#endif // TRACER_H
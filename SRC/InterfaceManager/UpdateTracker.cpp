@@ -0,0 +1,67 @@
+#include "UpdateTracker.h"
+
+////////////////////////////////////////////////////////////
+///////             UpdateTracker                 //////////
+////////////////////////////////////////////////////////////
+
+void UpdateTracker::reset(const InterfaceInfoStorage& snapshot)
+{
+    mDevices.clear();
+
+    for(auto& interface : snapshot)
+    {
+        DeviceState& state = mDevices[interface.first];
+        state.generation = interface.second.generation;
+        state.present = true;
+    }
+}
+
+UpdateState UpdateTracker::track(const InterfaceInfo& info, const bool& action)
+{
+    auto device = mDevices.find(info.id);
+
+    /**< Generations of devices removed before the tracker started are unknown */
+    if(device == mDevices.end())
+    {
+        DeviceState& state = mDevices[info.id];
+        state.generation = info.generation;
+        state.present = action;
+
+        return action? UPDATE_IN_ORDER : UPDATE_STALE;
+    }
+
+    DeviceState& state = device->second;
+    UpdateState result = UPDATE_GAP;
+
+    if(action)
+    {
+        if(info.generation <= state.generation){
+            return UPDATE_STALE;
+        }
+
+        /**< Generations are shared by all devices, so a lost removal shows only as an addition to a present device */
+        if(!state.present){
+            result = UPDATE_IN_ORDER;
+        }
+    }
+    else
+    {
+        if(info.generation < state.generation || (info.generation == state.generation && !state.present)){
+            return UPDATE_STALE;
+        }
+
+        if(info.generation == state.generation){
+            result = UPDATE_IN_ORDER;
+        }
+    }
+
+    state.generation = info.generation;
+    state.present = action;
+
+    return result;
+}
+
+void UpdateTracker::forget(const std::string& deviceId)
+{
+    mDevices.erase(deviceId);
+}
@@ -0,0 +1,49 @@
+#ifndef UPDATETRACKER_H
+#define UPDATETRACKER_H
+
+/**
+* @file UpdateTracker.h
+* @brief Contains a consumer-side check of the update generations of every device
+*/
+
+#include "AbstractInterfaceManagerImpl.h"
+
+enum UpdateState
+{
+    UPDATE_IN_ORDER,        /**< Follows the previous update of the device */
+    UPDATE_STALE,           /**< Already reflected, e.g. by a snapshot taken after the update was emitted */
+    UPDATE_GAP              /**< Updates of the device have been missed, it should be resynced */
+};
+
+////////////////////////////////////////////////////////////
+///////             UpdateTracker                 //////////
+////////////////////////////////////////////////////////////
+
+/**
+* @class UpdateTracker
+* @brief Remembers the last generation seen for every device. An addition must bring
+*  a newer generation to an absent device, a removal the current one. An addition and
+*  removal lost together leave the device as it was and are only seen in the sequence.
+*  Updates must be passed in the order of their device, which InterfaceManager guarantees.
+*  Not thread-safe
+*/
+
+class UpdateTracker
+{
+private:
+    struct DeviceState
+    {
+        uint64_t generation;
+        bool present;
+    };
+
+public:
+    void reset(const InterfaceInfoStorage& snapshot);            /**< Starts over from a snapshot */
+    UpdateState track(const InterfaceInfo& info, const bool& action);
+    void forget(const std::string& deviceId);                    /**< E.g. after the device has been resynced */
+
+private:
+    std::map<std::string, DeviceState> mDevices;
+};
+
+#endif // UPDATETRACKER_H
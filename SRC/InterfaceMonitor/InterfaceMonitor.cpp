@@ -1,72 +1,186 @@
 #include "InterfaceMonitor.h"
+#include "Tracer.h"
 
 ////////////////////////////////////////////////////////////
 ///////            InterfaceMonitor               //////////
 ////////////////////////////////////////////////////////////
 
 InterfaceMonitor::InterfaceMonitor(io_service& io, const uint& printPeriodMsec, std::ostream* stream) :
+                   InterfaceMonitor(io, printPeriodMsec, ImplPtr(new InterfaceManagerImpl), stream)
+{
+
+}
+
+InterfaceMonitor::InterfaceMonitor(io_service& io, const uint& printPeriodMsec, ImplPtr impl, std::ostream* stream) :
+                   mRunning(false),
+                   mOutputStream(stream),
+                   mOutputFormat(FORMAT_TEXT),
                    mPrintPeriodMsec(printPeriodMsec),
                    mPrintTimer(io, msec(printPeriodMsec)),
-                   mOutputStream(stream)
+                   mLineCacheValid(false),
+                   mDumpDirty(true)
 
 {      
-    mManager = InterfaceManagerPtr(new InterfaceManager(io));
+    mManager = InterfaceManagerPtr(new InterfaceManager(io, std::move(impl)));
     mManager->interfaceUpdateSignal.connect(boost::bind(&InterfaceMonitor::onInterfaceListUpdate, this, _1, _2));
     mManager->updateFailedSignal.connect(boost::bind(&InterfaceMonitor::onUpdateFailed, this));
 }
 
 void InterfaceMonitor::start()
 {
-   unique_lock(mMutex);
+   TRACE_SPAN("InterfaceMonitor::start");
+   unique_lock lock(mMutex);
 
    mManager->updateDevices();
+   rebuildLineCache();
+   publishTable();
    mManager->startListening();
-   startTimer();
+
+   mRunning = true;
+
+   if(mPrintPeriodMsec){
+       startTimer();
+   }
 }
 
 void InterfaceMonitor::stop()
 {
-    unique_lock(mMutex);
+    unique_lock lock(mMutex);
 
+    mRunning = false;
     mManager->stopListening();
     mPrintTimer.cancel();
 }
 
 void InterfaceMonitor::printInterfaces() const
 {
-    unique_lock(mMutex);
-    const InterfaceInfoStorage interfaceData = mManager->getInterfaceData();
+    unique_lock lock(mMutex);
+    writeDump();
+}
 
-    for(auto& interface : interfaceData)
+void InterfaceMonitor::printOnce()
+{
+    TRACE_SPAN("InterfaceMonitor::printOnce");
+    unique_lock lock(mMutex);
+
+    mManager->updateDevices();
+    rebuildLineCache();
+    publishTable();
+    writeDump();
+}
+
+void InterfaceMonitor::writeDump() const
+{
+    TRACE_SPAN("InterfaceMonitor::writeDump");
+    if(!mLineCacheValid){
+        rebuildLineCache();
+    }
+
+    if(mDumpDirty)
     {
-        const InterfaceInfo& info = interface.second;
-        std::string message = (boost::format("%s %s")
-                              % IFACE
-                              % serializeInterfaceInfo(info)).str();
+        mDump.clear();
 
-        (*mOutputStream)<<message<<std::endl;
+        for(auto& line : mLineCache){
+            mDump += line.second;
+        }
+
+        mDumpDirty = false;
     }
+
+    /**< The whole dump is a single write */
+    mOutputStream->write(mDump.data(), mDump.size());
+    mOutputStream->flush();
+}
+
+void InterfaceMonitor::rebuildLineCache() const
+{
+    TRACE_SPAN("InterfaceMonitor::rebuildLineCache");
+    const InterfaceInfoStorage interfaceData = mManager->getInterfaceData();
+
+    mLineCache.clear();
+    mTracker.reset(interfaceData);
+
+    for(auto& interface : interfaceData){
+        mLineCache[interface.first] = InterfaceSerializer::serializeListEntry(interface.second, mOutputFormat) + "\n";
+    }
+
+    mLineCacheValid = true;
+    mDumpDirty = true;
 }
 
 void InterfaceMonitor::onInterfaceListUpdate(const InterfaceInfo &info, const bool& action) const
 {
-    unique_lock(mMutex);
+    /**< Serializing outside of the lock lets updates of different interfaces be handled in parallel */
+    unique_lock lock(mMutex);
+    const OutputFormat format = mOutputFormat;
+    lock.unlock();
+
+    const std::string message = InterfaceSerializer::serializeUpdate(info, action, format);
+    const std::string line = action? InterfaceSerializer::serializeListEntry(info, format) + "\n" : std::string();
+
+    lock.lock();
 
-    std::string message = (boost::format("%s %s")
-                          % (action? IFACE_ADDED : IFACE_GONE)
-                          % (action? serializeInterfaceInfo(info) : info.name)).str();
+    /**< The format has been changed meanwhile, so the line does not match the cache */
+    if(format != mOutputFormat){
+        mLineCacheValid = false;
+    }
 
     (*mOutputStream)<<message<<std::endl;
+
+    UpdateState state = mTracker.track(info, action);
+    if(state == UPDATE_GAP){
+        mManager->resyncDevice(info.id, boost::bind(&InterfaceMonitor::onDeviceResync, this, _1, _2));
+    }
+
+    /**< A stale update must not undo a newer state the cache has been seeded with */
+    if(mLineCacheValid && state != UPDATE_STALE)
+    {
+        if(action){
+            mLineCache[info.id] = line;
+        }
+        else{
+            mLineCache.erase(info.id);
+        }
+
+        mDumpDirty = true;
+    }
+
+    publishTable();
 }
 
-void InterfaceMonitor::onUpdateFailed()
+void InterfaceMonitor::onDeviceResync(const InterfaceInfo& info, const bool& present) const
 {
-   unique_lock(mMutex);
+    unique_lock lock(mMutex);
+
+    mTracker.forget(info.id);
+
+    if(present){
+        mTracker.track(info, true);
+    }
+
+    if(mLineCacheValid)
+    {
+        if(present){
+            mLineCache[info.id] = InterfaceSerializer::serializeListEntry(info, mOutputFormat) + "\n";
+        }
+        else{
+            mLineCache.erase(info.id);
+        }
+
+        mDumpDirty = true;
+    }
+
+    publishTable();
+}
 
-   stop();
+void InterfaceMonitor::onUpdateFailed()
+{
+    unique_lock lock(mMutex);
 
-   /**< Handling is incumbent upon a user */
-   throw std::runtime_error("Update failed");
+    /**< Lost updates of single devices are resynced by the manager, so the monitor keeps running.
+         The next list is rebuilt from whatever the backend has */
+    std::cerr<<"Interface update failed"<<std::endl;
+    mLineCacheValid = false;
 }
 
 void InterfaceMonitor::startTimer(uint timeout)
@@ -78,41 +192,57 @@ void InterfaceMonitor::startTimer(uint timeout)
 
 void InterfaceMonitor::onTimeout(const boost::system::error_code &ec)
 {
-    if(!ec)
+    unique_lock lock(mMutex);
+
+    /**< The timer may have expired right before stop() */
+    if(!ec && mRunning)
     {
-        printInterfaces();
+        writeDump();
         startTimer(mPrintPeriodMsec);
     }
 }
 
 void InterfaceMonitor::setOutputStream(std::ostream* stream)
 {
-    unique_lock(mMutex);
+    unique_lock lock(mMutex);
 
     mOutputStream->flush();
     mOutputStream = stream;
 }
 
-std::string InterfaceMonitor::serializeInterfaceInfo(const InterfaceInfo &info) const
+void InterfaceMonitor::setOutputFormat(const OutputFormat& format)
 {
-   return  (boost::format("%s %s %s")
-            % info.name
-            % info.hwAddr
-            % typeTostring(info.type)).str();
+    unique_lock lock(mMutex);
+
+    mOutputFormat = format;
+    mLineCacheValid = false;
 }
 
-std::string InterfaceMonitor::typeTostring(const InterfaceType& type) const
+void InterfaceMonitor::enableTablePublishing(const std::string& shmName)
 {
-    std::string strType;
+    unique_lock lock(mMutex);
+
+    mTableWriter = SharedTableWriterPtr(new SharedTableWriter(shmName));
+}
 
-    switch(type)
+void InterfaceMonitor::publishTable() const
+{
+    if(mTableWriter == nullptr){
+        return;
+    }
+
+    const InterfaceInfoStorage interfaceData = mManager->getInterfaceData();
+
+    std::vector<SharedInterfaceEntry> entries;
+    entries.reserve(interfaceData.size());
+
+    for(auto& interface : interfaceData)
     {
-    case IF_TYPE_ETH:        strType = IFACE_ETH_NAME;      break;
-    case IF_TYPE_TUN:        strType = IFACE_TUN_NAME;      break;
-    default:                 strType = IFACE_UNKNOWN_NAME;  break;
+        const InterfaceInfo& info = interface.second;
+        entries.push_back(SharedInterfaceEntry(interface.first, info.name, info.hwAddr, info.type));
     }
 
-    return strType;
+    mTableWriter->publish(entries);
 }
 
 InterfaceMonitor::~InterfaceMonitor()
@@ -10,21 +10,16 @@
 */
 
 #include "InterfaceManager.h"
-#include <boost/format.hpp>
+#include "SharedInterfaceTable.h"
+#include "InterfaceSerializer.h"
+#include "UpdateTracker.h"
 #include <fstream>
 
-typedef std::unique_ptr<InterfaceManager> InterfaceManagerPtr;
+typedef std::unique_ptr<SharedTableWriter> SharedTableWriterPtr;
 typedef unsigned int uint;
 
 using namespace boost::asio;
 
-#define IFACE_GONE              "GONE"
-#define IFACE_ADDED             "NEW"
-#define IFACE                   "IFACE"
-#define IFACE_ETH_NAME          "Ethernet"
-#define IFACE_TUN_NAME          "Tunnel"
-#define IFACE_UNKNOWN_NAME      "Unknown"
-
 ////////////////////////////////////////////////////////////
 ///////            InterfaceMonitor               //////////
 ////////////////////////////////////////////////////////////
@@ -37,27 +32,48 @@ private:
     //slots
     void onTimeout(const boost::system::error_code &ec);    
     void onInterfaceListUpdate (const InterfaceInfo& info, const bool& action) const;
+    void onDeviceResync(const InterfaceInfo& info, const bool& present) const;
     void onUpdateFailed();
 
-    std::string serializeInterfaceInfo(const InterfaceInfo& info) const;  /**< Iface info -> string */  
-    std::string typeTostring(const InterfaceType& type) const; 
+    /**< The functions below expect mMutex to be locked */
+    void writeDump() const;                       /**< Writes all cached lines to the output */
+    void publishTable() const;                    /**< Writes the current table to shared memory */
+    void rebuildLineCache() const;                /**< Serializes the whole table into mLineCache */
 
 public:
+    /**< A zero print period disables the interface list dumps, only updates are printed */
     InterfaceMonitor(io_service& io, const uint& printPeriodMsec, std::ostream* stream = &std::cout);
+    InterfaceMonitor(io_service& io, const uint& printPeriodMsec, ImplPtr impl, std::ostream* stream = &std::cout);
     ~InterfaceMonitor();
 
     void start();                                 /**< Starts printing ifaces */
     void stop();                                  /**< Stops printing ifaces */
     void printInterfaces() const;
+    void printOnce();                             /**< Enumerates and prints ifaces without listening to updates */
     void setOutputStream(std::ostream* stream);
+    void setOutputFormat(const OutputFormat& format);
+    void enableTablePublishing(const std::string& shmName = IFTABLE_DEFAULT_NAME);  /**< Publisher mode, see SharedInterfaceTable.h */
 
 private:
     InterfaceManagerPtr mManager;
+    SharedTableWriterPtr mTableWriter;             /**< Set in publisher mode only */
 
-    boost::mutex mMutex;
+    /**< The monitor may be driven by several threads running the event loop,
+         all its state is guarded by mMutex */
+    mutable boost::mutex mMutex;
+    bool mRunning;
     std::ostream* mOutputStream;
+    OutputFormat mOutputFormat;
     uint mPrintPeriodMsec;                         /**< Interface info print period in msec */    
     deadline_timer mPrintTimer;  
+
+    /**< Full dumps are written from already serialized lines, an entry is only
+         reserialized when its interface is added or removed */
+    mutable std::map<std::string, std::string> mLineCache;  /**< Device id -> "IFACE ...\n" */
+    mutable std::string mDump;                              /**< All cached lines in one buffer */
+    mutable bool mLineCacheValid;                           /**< The cache has been seeded from the table */
+    mutable bool mDumpDirty;                                /**< mDump has to be rebuilt from mLineCache */
+    mutable UpdateTracker mTracker;                         /**< Seeded together with the line cache */
 };
 
 #endif // INTERFACEMANAGER_H
@@ -0,0 +1,122 @@
+#include "InterfaceSerializer.h"
+
+////////////////////////////////////////////////////////////
+///////            InterfaceSerializer            //////////
+////////////////////////////////////////////////////////////
+
+std::string InterfaceSerializer::serializeInterfaceInfo(const InterfaceInfo &info)
+{
+   return  (boost::format("%s %s %s")
+            % info.name
+            % info.hwAddr
+            % typeToString(info.type)).str();
+}
+
+std::string InterfaceSerializer::serializeListEntry(const InterfaceInfo &info, const OutputFormat& format)
+{
+    if(format == FORMAT_JSON){
+        return serializeJson(IFACE, info, true);
+    }
+
+    return (boost::format("%s %s")
+            % IFACE
+            % serializeInterfaceInfo(info)).str();
+}
+
+std::string InterfaceSerializer::serializeUpdate(const InterfaceInfo &info, const bool& action, const OutputFormat& format)
+{
+    if(format == FORMAT_JSON)
+    {
+        /**< Lets consumers find missed updates, see UpdateTracker */
+        std::string json = serializeJson(action? IFACE_ADDED : IFACE_GONE, info, action);
+        json.insert(json.size() - 1, (boost::format(",\"sequence\":%d,\"generation\":%d")
+                                      % info.sequence
+                                      % info.generation).str());
+        return json;
+    }
+
+    return (boost::format("%s %s")
+            % (action? IFACE_ADDED : IFACE_GONE)
+            % (action? serializeInterfaceInfo(info) : info.name)).str();
+}
+
+std::string InterfaceSerializer::serializeHistoryEntry(const HistoryEvent& event, const OutputFormat& format)
+{
+    const std::string time = boost::posix_time::to_iso_extended_string(event.time) + "Z";
+
+    if(format == FORMAT_JSON)
+    {
+        std::string json = serializeJson(event.action? IFACE_ADDED : IFACE_GONE, event.info, event.action);
+        json.insert(json.size() - 1, ",\"time\":\"" + time + "\"");
+        return json;
+    }
+
+    return time + " " + serializeUpdate(event.info, event.action);
+}
+
+std::string InterfaceSerializer::serializeJson(const char* event, const InterfaceInfo& info, const bool& details)
+{
+    std::string json = (boost::format("{\"event\":\"%s\",\"name\":\"%s\"")
+                        % event
+                        % escapeJson(info.name)).str();
+
+    if(details)
+    {
+        json += (boost::format(",\"hwAddr\":\"%s\",\"type\":\"%s\"")
+                 % escapeJson(info.hwAddr)
+                 % typeToString(info.type)).str();
+    }
+
+    return json + "}";
+}
+
+std::string InterfaceSerializer::escapeJson(const std::string& value)
+{
+    std::string escaped;
+    escaped.reserve(value.size());
+
+    for(char c : value)
+    {
+        if(c == '"' || c == '\\'){
+            escaped += '\\';
+            escaped += c;
+        }
+        else if((unsigned char)c < 0x20){
+            escaped += (boost::format("\\u%04x") % int(c)).str();
+        }
+        else{
+            escaped += c;
+        }
+    }
+
+    return escaped;
+}
+
+bool InterfaceSerializer::formatFromString(const std::string& name, OutputFormat& format)
+{
+    if(name == FORMAT_TEXT_NAME){
+        format = FORMAT_TEXT;
+    }
+    else if(name == FORMAT_JSON_NAME){
+        format = FORMAT_JSON;
+    }
+    else{
+        return false;
+    }
+
+    return true;
+}
+
+std::string InterfaceSerializer::typeToString(const InterfaceType& type)
+{
+    std::string strType;
+
+    switch(type)
+    {
+    case IF_TYPE_ETH:        strType = IFACE_ETH_NAME;      break;
+    case IF_TYPE_TUN:        strType = IFACE_TUN_NAME;      break;
+    default:                 strType = IFACE_UNKNOWN_NAME;  break;
+    }
+
+    return strType;
+}
@@ -0,0 +1,56 @@
+#ifndef INTERFACESERIALIZER_H
+#define INTERFACESERIALIZER_H
+
+/**
+* @file InterfaceSerializer.h
+* @brief Contains the text representation of interface lists and updates
+*  shared by the monitor output and the socket server protocol
+*/
+
+#include <string>
+#include <boost/format.hpp>
+
+#include "AbstractInterfaceManagerImpl.h"
+#include "InterfaceHistory.h"
+
+#define IFACE_GONE              "GONE"
+#define IFACE_ADDED             "NEW"
+#define IFACE                   "IFACE"
+#define IFACE_ETH_NAME          "Ethernet"
+#define IFACE_TUN_NAME          "Tunnel"
+#define IFACE_UNKNOWN_NAME      "Unknown"
+
+#define FORMAT_TEXT_NAME        "text"
+#define FORMAT_JSON_NAME        "json"
+
+/**< Output formats. Text lines are "IFACE|NEW|GONE name hwAddr type",
+     json lines are objects like {"event":"NEW","name":"eth0","hwAddr":"...","type":"Ethernet"} */
+enum OutputFormat
+{
+    FORMAT_TEXT,
+    FORMAT_JSON
+};
+
+////////////////////////////////////////////////////////////
+///////            InterfaceSerializer            //////////
+////////////////////////////////////////////////////////////
+
+class InterfaceSerializer
+{
+private:
+    static std::string serializeJson(const char* event, const InterfaceInfo& info, const bool& details);
+    static std::string escapeJson(const std::string& value);
+
+public:
+    static std::string serializeInterfaceInfo(const InterfaceInfo& info);                  /**< "name hwAddr type" */
+    static std::string serializeListEntry(const InterfaceInfo& info,
+                                          const OutputFormat& format = FORMAT_TEXT);       /**< "IFACE name hwAddr type" */
+    static std::string serializeUpdate(const InterfaceInfo& info, const bool& action,
+                                       const OutputFormat& format = FORMAT_TEXT);          /**< "NEW name hwAddr type" or "GONE name" */
+    static std::string serializeHistoryEntry(const HistoryEvent& event,
+                                             const OutputFormat& format = FORMAT_TEXT);    /**< "<UTC time> NEW|GONE ..." */
+    static std::string typeToString(const InterfaceType& type);
+    static bool formatFromString(const std::string& name, OutputFormat& format);           /**< Returns false for unknown names */
+};
+
+#endif // INTERFACESERIALIZER_H
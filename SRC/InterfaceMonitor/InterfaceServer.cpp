@@ -0,0 +1,367 @@
+#include "InterfaceServer.h"
+
+////////////////////////////////////////////////////////////
+///////              ServerSession                //////////
+////////////////////////////////////////////////////////////
+
+ServerSession::ServerSession(io_service& io, InterfaceServer& server) :
+    mSocket(io),
+    mServer(server),
+    mRequest(SERVER_MAX_REQUEST),
+    mWriting(false),
+    mClosed(false),
+    mReadDone(false),
+    mSubscribed(false),
+    mSnapshotSequence(0)
+{
+
+}
+
+LocalSocket& ServerSession::getSocket()
+{
+    return mSocket;
+}
+
+void ServerSession::start()
+{
+    readRequest();
+}
+
+bool ServerSession::send(const MessagePtr& message, const size_t& maxQueue)
+{
+    if(mClosed){
+        return true;
+    }
+
+    if(mQueue.size() >= maxQueue){
+        return false;
+    }
+
+    mQueue.push_back(message);
+
+    if(!mWriting){
+        writeQueue();
+    }
+
+    return true;
+}
+
+void ServerSession::close()
+{
+    if(!mClosed)
+    {
+        mClosed = true;
+        mQueue.clear();
+
+        boost::system::error_code ec;
+        mSocket.close(ec);
+    }
+}
+
+void ServerSession::subscribe(const uint64_t& snapshotSequence)
+{
+    mSubscribed = true;
+    mSnapshotSequence = snapshotSequence;
+}
+
+bool ServerSession::isSubscribed() const
+{
+    return mSubscribed;
+}
+
+bool ServerSession::isReflected(const uint64_t& sequence) const
+{
+    return sequence != 0 && sequence <= mSnapshotSequence;
+}
+
+void ServerSession::readRequest()
+{
+    async_read_until(mSocket, mRequest, '\n',
+                     mServer.mStrand.wrap(boost::bind(&ServerSession::onRequest, shared_from_this(),
+                                                      boost::asio::placeholders::error,
+                                                      boost::asio::placeholders::bytes_transferred)));
+}
+
+void ServerSession::onRequest(const boost::system::error_code& ec, const size_t& bytes)
+{
+    if(mClosed){
+        return;
+    }
+
+    if(ec == boost::asio::error::eof)
+    {
+        /**< No more requests, a last one may come without the newline */
+        mReadDone = true;
+
+        if(mRequest.size())
+        {
+            std::string request(buffers_begin(mRequest.data()), buffers_end(mRequest.data()));
+            mRequest.consume(mRequest.size());
+
+            mServer.handleRequest(shared_from_this(), request);
+        }
+
+        closeIfDone();
+        return;
+    }
+
+    if(ec)
+    {
+        /**< Disconnected or the request is longer than SERVER_MAX_REQUEST */
+        mServer.removeSession(shared_from_this());
+        return;
+    }
+
+    std::string request(buffers_begin(mRequest.data()), buffers_begin(mRequest.data()) + bytes - 1);
+    mRequest.consume(bytes);
+
+    mServer.handleRequest(shared_from_this(), request);
+
+    if(!mClosed){
+        readRequest();
+    }
+}
+
+void ServerSession::closeIfDone()
+{
+    if(!mClosed && mReadDone && !mSubscribed && !mWriting){
+        mServer.removeSession(shared_from_this());
+    }
+}
+
+void ServerSession::writeQueue()
+{
+    std::vector<const_buffer> buffers;
+    size_t messageCount = std::min<size_t>(mQueue.size(), SERVER_MAX_GATHER);
+    buffers.reserve(messageCount);
+
+    for(size_t i = 0; i < messageCount; ++i){
+        buffers.push_back(buffer(*mQueue[i]));
+    }
+
+    mWriting = true;
+    async_write(mSocket, buffers, mServer.mStrand.wrap(boost::bind(&ServerSession::onWrite, shared_from_this(),
+                                                                   boost::asio::placeholders::error, messageCount)));
+}
+
+void ServerSession::onWrite(const boost::system::error_code& ec, const size_t& messageCount)
+{
+    mWriting = false;
+
+    if(mClosed){
+        return;
+    }
+
+    if(ec)
+    {
+        mServer.removeSession(shared_from_this());
+        return;
+    }
+
+    mQueue.erase(mQueue.begin(), mQueue.begin() + messageCount);
+
+    if(!mQueue.empty()){
+        writeQueue();
+    }
+    else{
+        closeIfDone();
+    }
+}
+
+////////////////////////////////////////////////////////////
+///////              InterfaceServer              //////////
+////////////////////////////////////////////////////////////
+
+InterfaceServer::InterfaceServer(io_service& io, const std::string& socketPath, const size_t& maxQueue) :
+    InterfaceServer(io, ImplPtr(new InterfaceManagerImpl), socketPath, maxQueue)
+{
+
+}
+
+InterfaceServer::InterfaceServer(io_service& io, ImplPtr impl, const std::string& socketPath, const size_t& maxQueue) :
+    mEventLoop(io),
+    mStrand(io),
+    mAcceptor(io),
+    mSocketPath(socketPath),
+    mMaxQueue(maxQueue),
+    mOwnsSocket(false)
+{
+    mManager = InterfaceManagerPtr(new InterfaceManager(io, std::move(impl)));
+    mManager->interfaceUpdateSignal.connect(boost::bind(&InterfaceServer::onInterfaceListUpdate, this, _1, _2));
+    mManager->updateFailedSignal.connect(boost::bind(&InterfaceServer::onUpdateFailed, this));
+}
+
+void InterfaceServer::start()
+{
+    boost::asio::local::stream_protocol::endpoint endpoint(mSocketPath);
+
+    /**< A socket file left by a previous instance would make bind fail, but one a running server accepts on is not ours to replace */
+    boost::asio::local::stream_protocol::socket probe(mEventLoop);
+    boost::system::error_code ec;
+    probe.connect(endpoint, ec);
+
+    if(!ec){
+        throw std::runtime_error("Socket " + mSocketPath + " is in use by a running server");
+    }
+
+    if(ec == boost::asio::error::connection_refused){
+        ::unlink(mSocketPath.c_str());
+    }
+
+    mAcceptor.open(endpoint.protocol());
+    mAcceptor.bind(endpoint);
+    mOwnsSocket = true;
+    mAcceptor.listen();
+
+    mManager->updateDevices();
+    mManager->startListening();
+
+    startAccept();
+}
+
+void InterfaceServer::stop()
+{
+    mManager->stopListening();
+
+    boost::system::error_code ec;
+    mAcceptor.close(ec);
+
+    for(auto& session : mSessions){
+        session->close();
+    }
+
+    mSessions.clear();
+    mSubscribers.clear();
+}
+
+void InterfaceServer::startAccept()
+{
+    SessionPtr session(new ServerSession(mEventLoop, *this));
+    mAcceptor.async_accept(session->getSocket(), mStrand.wrap(boost::bind(&InterfaceServer::onAccept, this, session,
+                                                                          boost::asio::placeholders::error)));
+}
+
+void InterfaceServer::onAccept(const SessionPtr& session, const boost::system::error_code& ec)
+{
+    if(ec == boost::asio::error::operation_aborted){
+        return;
+    }
+
+    if(!ec)
+    {
+        mSessions.insert(session);
+        session->start();
+    }
+
+    startAccept();
+}
+
+void InterfaceServer::handleRequest(const SessionPtr& session, const std::string& request)
+{
+    if(request == SERVER_REQUEST_SNAPSHOT || request == SERVER_REQUEST_SUBSCRIBE)
+    {
+        /**< Updates are broadcast through the same strand, so none is lost between the snapshot and the subscription.
+             Those already queued to the strand when the snapshot is taken are reflected in it and skipped */
+        uint64_t sequence = 0;
+
+        if(!session->send(makeSnapshot(sequence), mMaxQueue)){
+            removeSession(session);
+        }
+        else if(request == SERVER_REQUEST_SUBSCRIBE)
+        {
+            session->subscribe(sequence);
+            mSubscribers.insert(session);
+        }
+    }
+    else if(request.compare(0, strlen(SERVER_REQUEST_HISTORY " "), SERVER_REQUEST_HISTORY " ") == 0)
+    {
+        char* end = nullptr;
+        const char* seconds = request.c_str() + strlen(SERVER_REQUEST_HISTORY " ");
+        uint32_t period = static_cast<uint32_t>(strtoul(seconds, &end, 10));
+
+        if(end == seconds || *end != '\0' || !session->send(makeHistory(period), mMaxQueue)){
+            removeSession(session);
+        }
+    }
+    else{
+        removeSession(session);
+    }
+}
+
+void InterfaceServer::removeSession(const SessionPtr& session)
+{
+    session->close();
+    mSubscribers.erase(session);
+    mSessions.erase(session);
+}
+
+void InterfaceServer::broadcast(const MessagePtr& message, const uint64_t& sequence)
+{
+    std::vector<SessionPtr> laggards;
+
+    for(auto& session : mSubscribers)
+    {
+        if(session->isReflected(sequence)){
+            continue;
+        }
+
+        if(!session->send(message, mMaxQueue)){
+            laggards.push_back(session);
+        }
+    }
+
+    for(auto& session : laggards){
+        removeSession(session);
+    }
+}
+
+MessagePtr InterfaceServer::makeSnapshot(uint64_t& sequence) const
+{
+    const InterfaceInfoStorage interfaceData = mManager->getInterfaceData(sequence);
+    std::string snapshot;
+
+    for(auto& interface : interfaceData){
+        snapshot += InterfaceSerializer::serializeListEntry(interface.second) + "\n";
+    }
+
+    snapshot += SERVER_SNAPSHOT_END "\n";
+
+    return std::make_shared<const std::string>(std::move(snapshot));
+}
+
+MessagePtr InterfaceServer::makeHistory(const uint32_t& seconds) const
+{
+    const HistoryTime now = boost::posix_time::microsec_clock::universal_time();
+    const HistoryEvents events = mManager->getHistory(now - boost::posix_time::seconds(seconds), now);
+    std::string history;
+
+    for(auto& event : events){
+        history += InterfaceSerializer::serializeHistoryEntry(event) + "\n";
+    }
+
+    history += SERVER_SNAPSHOT_END "\n";
+
+    return std::make_shared<const std::string>(std::move(history));
+}
+
+void InterfaceServer::onInterfaceListUpdate(const InterfaceInfo& info, const bool& action)
+{
+    /**< Serialized once for all subscribers */
+    MessagePtr message = std::make_shared<const std::string>(InterfaceSerializer::serializeUpdate(info, action) + "\n");
+    mStrand.dispatch(boost::bind(&InterfaceServer::broadcast, this, message, info.sequence));
+}
+
+void InterfaceServer::onUpdateFailed()
+{
+    MessagePtr message = std::make_shared<const std::string>(SERVER_ERROR "\n");
+    mStrand.dispatch(boost::bind(&InterfaceServer::broadcast, this, message, 0));
+}
+
+InterfaceServer::~InterfaceServer()
+{
+    stop();
+
+    if(mOwnsSocket){
+        ::unlink(mSocketPath.c_str());
+    }
+}
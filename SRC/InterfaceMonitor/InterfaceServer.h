@@ -0,0 +1,137 @@
+#ifndef INTERFACESERVER_H
+#define INTERFACESERVER_H
+
+/**
+* @file InterfaceServer.h
+* @brief Contains a local query/subscription server on a Unix domain socket.
+*  One process per host serves any number of clients from a single event loop.
+*  The protocol is line based:
+*   "SNAPSHOT"  - the server replies with "IFACE ..." lines followed by "END"
+*   "SUBSCRIBE" - same as SNAPSHOT, after that the client receives "NEW ..." / "GONE ..."
+*                 lines for each update not reflected in the snapshot until it disconnects
+*  A client may shut down its sending side once it has no more requests, the server
+*  flushes the replies and keeps sending updates to subscribers.
+*  Each update is serialized once and the same buffer is queued to every subscriber,
+*  queues are flushed with gathered writes. A subscriber whose queue exceeds
+*  the limit is disconnected instead of slowing down the others.
+*  The event loop may be run by several threads, all server and session
+*  handlers are serialized through the server strand
+*/
+
+#include <deque>
+#include <set>
+
+#include "InterfaceManager.h"
+#include "InterfaceSerializer.h"
+
+#define SERVER_DEFAULT_SOCKET_PATH  "/tmp/interfaceMonitor.sock"
+#define SERVER_DEFAULT_MAX_QUEUE    1024       /**< Messages queued per client before it is dropped */
+#define SERVER_MAX_GATHER           64         /**< Buffers passed to a single gathered write */
+#define SERVER_MAX_REQUEST          256        /**< Clients sending longer lines are dropped */
+
+#define SERVER_REQUEST_SNAPSHOT     "SNAPSHOT"
+#define SERVER_REQUEST_SUBSCRIBE    "SUBSCRIBE"
+#define SERVER_REQUEST_HISTORY      "HISTORY"  /**< "HISTORY <seconds>" lists the updates of the last seconds */
+#define SERVER_SNAPSHOT_END         "END"
+#define SERVER_ERROR                "ERROR"
+
+class InterfaceServer;
+class ServerSession;
+
+typedef boost::asio::local::stream_protocol::socket LocalSocket;
+typedef boost::asio::local::stream_protocol::acceptor LocalAcceptor;
+typedef std::shared_ptr<const std::string> MessagePtr;
+typedef std::shared_ptr<ServerSession> SessionPtr;
+
+////////////////////////////////////////////////////////////
+///////              ServerSession                //////////
+////////////////////////////////////////////////////////////
+
+/**
+* @class ServerSession
+* @brief A single client connection with its bounded send queue
+*/
+
+class ServerSession : public std::enable_shared_from_this<ServerSession>
+{
+public:
+    ServerSession(io_service& io, InterfaceServer& server);
+
+    LocalSocket& getSocket();
+    void start();
+    bool send(const MessagePtr& message, const size_t& maxQueue);  /**< Returns false if the queue is full */
+    void close();
+
+    void subscribe(const uint64_t& snapshotSequence);
+    bool isSubscribed() const;
+    bool isReflected(const uint64_t& sequence) const;   /**< True if the update was part of the snapshot */
+
+private:
+    void readRequest();
+    void writeQueue();
+    void closeIfDone();                 /**< Closes a session that has no more requests and replies */
+
+    //slots
+    void onRequest(const boost::system::error_code& ec, const size_t& bytes);
+    void onWrite(const boost::system::error_code& ec, const size_t& messageCount);
+
+private:
+    LocalSocket mSocket;
+    InterfaceServer& mServer;
+    boost::asio::streambuf mRequest;
+    std::deque<MessagePtr> mQueue;
+    bool mWriting;
+    bool mClosed;
+    bool mReadDone;                     /**< The client has shut down its sending side */
+    bool mSubscribed;
+    uint64_t mSnapshotSequence;         /**< The backend sequence the subscription snapshot reflects */
+};
+
+////////////////////////////////////////////////////////////
+///////              InterfaceServer              //////////
+////////////////////////////////////////////////////////////
+
+class InterfaceServer
+{
+    friend class ServerSession;
+
+private:
+    void startAccept();
+    void handleRequest(const SessionPtr& session, const std::string& request);
+    void removeSession(const SessionPtr& session);
+    void broadcast(const MessagePtr& message, const uint64_t& sequence);   /**< A zero sequence is sent to all */
+    MessagePtr makeSnapshot(uint64_t& sequence) const;
+    MessagePtr makeHistory(const uint32_t& seconds) const;
+
+    //slots
+    void onAccept(const SessionPtr& session, const boost::system::error_code& ec);
+    void onInterfaceListUpdate(const InterfaceInfo& info, const bool& action);
+    void onUpdateFailed();
+
+public:
+    InterfaceServer(io_service& io,
+                    const std::string& socketPath = SERVER_DEFAULT_SOCKET_PATH,
+                    const size_t& maxQueue = SERVER_DEFAULT_MAX_QUEUE);
+    InterfaceServer(io_service& io, ImplPtr impl,
+                    const std::string& socketPath = SERVER_DEFAULT_SOCKET_PATH,
+                    const size_t& maxQueue = SERVER_DEFAULT_MAX_QUEUE);
+    ~InterfaceServer();
+
+    void start();                                 /**< Starts listening to interfaces and clients, throws if another server owns the socket */
+    void stop();                                  /**< Disconnects all clients, must not run concurrently with the event loop */
+
+private:
+    io_service& mEventLoop;
+    io_service::strand mStrand;
+    InterfaceManagerPtr mManager;
+    LocalAcceptor mAcceptor;
+
+    std::string mSocketPath;
+    size_t mMaxQueue;
+    bool mOwnsSocket;                             /**< start() has bound the socket file, so it is removed with the server */
+
+    std::set<SessionPtr> mSessions;               /**< All connected clients */
+    std::set<SessionPtr> mSubscribers;            /**< Clients receiving updates */
+};
+
+#endif // INTERFACESERVER_H
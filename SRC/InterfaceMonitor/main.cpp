@@ -1,5 +1,10 @@
 #include "InterfaceMonitor.h"
+#include "InterfaceServer.h"
+#include "Tracer.h"
 #include <signal.h>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
 
 static boost::asio::io_service eventLoop;
 
@@ -9,6 +14,48 @@ void closeHandler (int sigNum)
    eventLoop.stop();
 }
 
+void onTraceDumpSignal(boost::asio::signal_set* signals, const boost::system::error_code& ec)
+{
+    if(!ec)
+    {
+        Tracer::instance().dump();
+        signals->async_wait(boost::bind(&onTraceDumpSignal, signals, boost::asio::placeholders::error));
+    }
+}
+
+void runEventLoop(const uint& threadCount)
+{
+    /**< An exception thrown by a handler on any thread stops the loop and is rethrown here */
+    std::exception_ptr error;
+    boost::mutex errorMutex;
+
+    auto run = [&]()
+    {
+        try{
+            eventLoop.run();
+        }
+        catch(...)
+        {
+            unique_lock lock(errorMutex);
+            error = std::current_exception();
+            eventLoop.stop();
+        }
+    };
+
+    boost::thread_group pool;
+
+    for(uint i = 1; i < threadCount; ++i){
+        pool.create_thread(run);
+    }
+
+    run();
+    pool.join_all();
+
+    if(error){
+        std::rethrow_exception(error);
+    }
+}
+
 int main(int argc, char **argv)
 {     
     /**< Close signals handling */
@@ -17,26 +64,128 @@ int main(int argc, char **argv)
     sigaction(SIGTERM, &action, NULL);
     sigaction(SIGINT, &action, NULL);
 
+    /**< Disconnected clients must not kill the server */
+    signal(SIGPIPE, SIG_IGN);
+
+    Tracer::instance().enableFromEnvironment();
+
     uint printTimeout = 5000;
+    uint threadCount = 1;
+    std::string formatName;
+    std::string backend;
+    std::string shmName;
+    std::string socketPath;
+    std::string tracePath;
+
+    po::options_description description("Options");
+    description.add_options()
+        ("help,h",  "Show this help")
+        ("once",    "Print the interface list once and exit, without listening to updates")
+        ("watch",   "Print interface updates only, without periodic interface lists")
+        ("period",  po::value<uint>(&printTimeout)->default_value(printTimeout), "Interface list print period, msec")
+        ("format",  po::value<std::string>(&formatName)->default_value(FORMAT_TEXT_NAME), "Output format: text or json")
+        ("backend", po::value<std::string>(&backend)->default_value(BACKEND_AUTO), "Interface backend: auto, nm or sysfs")
+        ("publish", po::value<std::string>(&shmName)->implicit_value(IFTABLE_DEFAULT_NAME),
+                    "Also publish the interface table to shared memory")
+        ("server",  po::value<std::string>(&socketPath)->implicit_value(SERVER_DEFAULT_SOCKET_PATH),
+                    "Serve snapshots and updates on a local socket instead of printing")
+        ("threads", po::value<uint>(&threadCount)->default_value(threadCount), "Event loop threads")
+        ("trace",   po::value<std::string>(&tracePath),
+                    "Record internal spans to a Chrome trace file (also IFMON_TRACE), written on exit and on SIGUSR1");
+
+    po::variables_map options;
+    OutputFormat format = FORMAT_TEXT;
 
     try
     {
-        boost::asio::io_service::work work(eventLoop);
+        po::store(po::parse_command_line(argc, argv, description), options);
+        po::notify(options);
 
-        InterfaceMonitor mon(eventLoop, printTimeout);
-        mon.start();
+        if(!InterfaceSerializer::formatFromString(formatName, format)){
+            throw std::runtime_error("Unknown format " + formatName);
+        }
 
-        eventLoop.run();
+        /**< The table is unlinked when the monitor exits, readers would never see a one-shot one */
+        if(options.count("once") && options.count("publish")){
+            throw std::runtime_error("--publish needs a running monitor and cannot be combined with --once");
+        }
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr<<e.what()<<"\n"<<description<<std::endl;
+        return 1;
+    }
+
+    if(options.count("help"))
+    {
+        std::cout<<description<<std::endl;
+        return 0;
+    }
+
+    if(!tracePath.empty()){
+        Tracer::instance().enable(tracePath);
+    }
+
+    try
+    {
+        if(options.count("once"))
+        {
+            /**< No listener, timer or backend thread is set up */
+            InterfaceMonitor mon(eventLoop, 0, InterfaceManager::createImpl(backend));
+            mon.setOutputFormat(format);
+            mon.printOnce();
+
+            /**< Delivers an update failure, if any */
+            eventLoop.poll();
+        }
+        else
+        {
+            boost::asio::io_service::work work(eventLoop);
+
+            boost::asio::signal_set traceSignals(eventLoop, SIGUSR1);
+            traceSignals.async_wait(boost::bind(&onTraceDumpSignal, &traceSignals, boost::asio::placeholders::error));
+
+            if(options.count("server"))
+            {
+                InterfaceServer server(eventLoop, InterfaceManager::createImpl(backend), socketPath);
+                server.start();
+
+                runEventLoop(std::max<uint>(threadCount, 1));
+            }
+            else
+            {
+                InterfaceMonitor mon(eventLoop, options.count("watch")? 0 : printTimeout,
+                                     InterfaceManager::createImpl(backend));
+                mon.setOutputFormat(format);
+
+                if(options.count("publish")){
+                    mon.enableTablePublishing(shmName);
+                }
+
+                mon.start();
+
+                runEventLoop(std::max<uint>(threadCount, 1));
+            }
+        }
     }
     catch(const std::exception& e)
     {
         std::cout<<e.what()<<std::endl;
         eventLoop.stop();
+
+        if(Tracer::isEnabled()){
+            Tracer::instance().dump();
+        }
+
         return 1;
     }
     catch (...){
         std::cerr << "Unknown exception caught\n";
     }
 
+    if(Tracer::isEnabled()){
+        Tracer::instance().dump();
+    }
+
     return 0;
 }
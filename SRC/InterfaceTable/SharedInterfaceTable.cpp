@@ -0,0 +1,296 @@
+#include "SharedInterfaceTable.h"
+
+#include <stdexcept>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static void copyField(char* dest, const std::string& src, const size_t& size)
+{
+    size_t length = std::min(src.length(), size - 1);
+    memcpy(dest, src.c_str(), length);
+    dest[length] = '\0';
+}
+
+/**< The starttime field of /proc/<pid>/stat, 0 if it cannot be read */
+static uint64_t getProcessStartTime(const int32_t& pid)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+
+    FILE* file = fopen(path, "r");
+    if(file == nullptr){
+        return 0;
+    }
+
+    char stat[1024];
+    size_t size = fread(stat, 1, sizeof(stat) - 1, file);
+    fclose(file);
+    stat[size] = '\0';
+
+    /**< The command name may contain spaces, fields are counted from its closing parenthesis */
+    const char* field = strrchr(stat, ')');
+    for(int i = 2; field != nullptr && i < 22; ++i)
+    {
+        field = strchr(field + 1, ' ');
+    }
+
+    return field != nullptr? strtoull(field + 1, nullptr, 10) : 0;
+}
+
+static bool isProcessAlive(const int32_t& pid, const uint64_t& startTime)
+{
+    if(pid <= 0 || (kill(pid, 0) != 0 && errno != EPERM)){
+        return false;
+    }
+
+    uint64_t currentStartTime = getProcessStartTime(pid);
+    return startTime == 0 || currentStartTime == 0 || currentStartTime == startTime;
+}
+
+/**< Returns true if the region exists and its writer is still running */
+static bool isRegionOwned(const std::string& shmName, int32_t& owner)
+{
+    int fd = shm_open(shmName.c_str(), O_RDONLY, 0);
+    if(fd < 0){
+        return false;
+    }
+
+    struct stat st;
+    void* mem = MAP_FAILED;
+
+    if(fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(SharedTableHeader)){
+        mem = mmap(NULL, sizeof(SharedTableHeader), PROT_READ, MAP_SHARED, fd, 0);
+    }
+
+    close(fd);
+
+    if(mem == MAP_FAILED){
+        return false;
+    }
+
+    const SharedTableHeader* header = static_cast<const SharedTableHeader*>(mem);
+
+    /**< Regions of other layouts have no owner to check */
+    bool owned = header->magic == IFTABLE_MAGIC &&
+                 header->version == IFTABLE_VERSION &&
+                 header->closed.load(std::memory_order_acquire) == 0 &&
+                 isProcessAlive(header->ownerPid, header->ownerStartTime);
+
+    owner = header->ownerPid;
+    munmap(mem, sizeof(SharedTableHeader));
+
+    return owned;
+}
+
+////////////////////////////////////////////////////////////
+///////           SharedInterfaceEntry            //////////
+////////////////////////////////////////////////////////////
+
+SharedInterfaceEntry::SharedInterfaceEntry() : type(0)
+{
+    id[0] = name[0] = hwAddr[0] = '\0';
+}
+
+SharedInterfaceEntry::SharedInterfaceEntry(const std::string& id, const std::string& name,
+                                           const std::string& hwAddr, const uint32_t& type) :
+    type(type)
+{
+    copyField(this->id, id, sizeof(this->id));
+    copyField(this->name, name, sizeof(this->name));
+    copyField(this->hwAddr, hwAddr, sizeof(this->hwAddr));
+}
+
+////////////////////////////////////////////////////////////
+///////           SharedTableWriter               //////////
+////////////////////////////////////////////////////////////
+
+SharedTableWriter::SharedTableWriter(const std::string& shmName, const uint32_t& capacity) :
+    mShmName(shmName),
+    mSize(sizeof(SharedTableHeader) + capacity * sizeof(SharedInterfaceEntry)),
+    mHeader(nullptr),
+    mEntries(nullptr)
+{
+    int32_t owner = 0;
+    if(isRegionOwned(mShmName, owner)){
+        throw std::runtime_error("Shared memory " + mShmName + " is in use by process " + std::to_string(owner));
+    }
+
+    /**< A region left by a crashed writer is replaced */
+    shm_unlink(mShmName.c_str());
+
+    int fd = shm_open(mShmName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if(fd < 0){
+        throw std::runtime_error("Failed to create shared memory " + mShmName + ": " + strerror(errno));
+    }
+
+    void* mem = MAP_FAILED;
+    if(ftruncate(fd, mSize) == 0){
+        mem = mmap(NULL, mSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+
+    close(fd);
+
+    if(mem == MAP_FAILED)
+    {
+        std::string errorText = strerror(errno);
+        shm_unlink(mShmName.c_str());
+        throw std::runtime_error("Failed to map shared memory " + mShmName + ": " + errorText);
+    }
+
+    mHeader = static_cast<SharedTableHeader*>(mem);
+    mEntries = reinterpret_cast<SharedInterfaceEntry*>(mHeader + 1);
+
+    mHeader->capacity = capacity;
+    mHeader->entrySize = sizeof(SharedInterfaceEntry);
+    mHeader->count = 0;
+    mHeader->overflow = 0;
+    mHeader->closed.store(0, std::memory_order_relaxed);
+    mHeader->ownerPid = getpid();
+    mHeader->ownerStartTime = getProcessStartTime(getpid());
+    mHeader->sequence.store(0, std::memory_order_relaxed);
+    mHeader->version = IFTABLE_VERSION;
+
+    /**< Readers validate the magic, so it goes last */
+    std::atomic_thread_fence(std::memory_order_release);
+    mHeader->magic = IFTABLE_MAGIC;
+}
+
+void SharedTableWriter::publish(const std::vector<SharedInterfaceEntry>& entries)
+{
+    uint32_t count = std::min<size_t>(entries.size(), mHeader->capacity);
+    uint64_t sequence = mHeader->sequence.load(std::memory_order_relaxed);
+
+    /**< Odd sequence tells readers an update is in progress */
+    mHeader->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    if(count){
+        memcpy(mEntries, entries.data(), count * sizeof(SharedInterfaceEntry));
+    }
+
+    mHeader->count = count;
+    mHeader->overflow = entries.size() - count;
+
+    mHeader->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+uint64_t SharedTableWriter::getSequence() const
+{
+    return mHeader->sequence.load(std::memory_order_relaxed);
+}
+
+SharedTableWriter::~SharedTableWriter()
+{
+    if(mHeader != nullptr)
+    {
+        mHeader->closed.store(1, std::memory_order_release);
+        munmap(mHeader, mSize);
+        shm_unlink(mShmName.c_str());
+    }
+}
+
+////////////////////////////////////////////////////////////
+///////           SharedTableReader               //////////
+////////////////////////////////////////////////////////////
+
+SharedTableReader::SharedTableReader(const std::string& shmName) :
+    mSize(0),
+    mHeader(nullptr),
+    mEntries(nullptr)
+{
+    int fd = shm_open(shmName.c_str(), O_RDONLY, 0);
+    if(fd < 0){
+        throw std::runtime_error("Failed to open shared memory " + shmName + ": " + strerror(errno));
+    }
+
+    struct stat st;
+    void* mem = MAP_FAILED;
+
+    if(fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(SharedTableHeader))
+    {
+        mSize = st.st_size;
+        mem = mmap(NULL, mSize, PROT_READ, MAP_SHARED, fd, 0);
+    }
+
+    close(fd);
+
+    if(mem == MAP_FAILED){
+        throw std::runtime_error("Failed to map shared memory " + shmName);
+    }
+
+    mHeader = static_cast<const SharedTableHeader*>(mem);
+    mEntries = reinterpret_cast<const SharedInterfaceEntry*>(mHeader + 1);
+
+    bool layoutOk = mHeader->magic == IFTABLE_MAGIC &&
+                    mHeader->version == IFTABLE_VERSION &&
+                    mHeader->entrySize == sizeof(SharedInterfaceEntry) &&
+                    mSize >= sizeof(SharedTableHeader) + mHeader->capacity * sizeof(SharedInterfaceEntry);
+
+    if(!layoutOk)
+    {
+        munmap(const_cast<SharedTableHeader*>(mHeader), mSize);
+        throw std::runtime_error("Incompatible shared interface table " + shmName);
+    }
+}
+
+bool SharedTableReader::read(std::vector<SharedInterfaceEntry>& entries, uint64_t* sequence) const
+{
+    for(uint32_t attempt = 0; attempt < IFTABLE_READ_RETRIES; ++attempt)
+    {
+        if(isClosed()){
+            return false;
+        }
+
+        uint64_t before = mHeader->sequence.load(std::memory_order_acquire);
+        if(before & 1){
+            continue;
+        }
+
+        /**< The count may be torn if the writer interferes, the sequence check below catches it */
+        uint32_t count = std::min(mHeader->count, mHeader->capacity);
+        entries.assign(mEntries, mEntries + count);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t after = mHeader->sequence.load(std::memory_order_relaxed);
+
+        if(before == after)
+        {
+            if(sequence != nullptr){
+                *sequence = before;
+            }
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+uint64_t SharedTableReader::getSequence() const
+{
+    return mHeader->sequence.load(std::memory_order_acquire);
+}
+
+bool SharedTableReader::isClosed() const
+{
+    return mHeader->closed.load(std::memory_order_acquire) != 0;
+}
+
+bool SharedTableReader::isWriterAlive() const
+{
+    return !isClosed() && isProcessAlive(mHeader->ownerPid, mHeader->ownerStartTime);
+}
+
+SharedTableReader::~SharedTableReader()
+{
+    if(mHeader != nullptr){
+        munmap(const_cast<SharedTableHeader*>(mHeader), mSize);
+    }
+}
@@ -0,0 +1,142 @@
+#ifndef SHAREDINTERFACETABLE_H
+#define SHAREDINTERFACETABLE_H
+
+/**
+* @file SharedInterfaceTable.h
+* @brief Contains the layout of the interface table published into POSIX shared memory,
+*  its writer (used by the publishing monitor) and a reader for local agents.
+*  The table is guarded by a seqlock: the writer makes the sequence odd while updating
+*  and even when done, so readers copy a consistent snapshot without syscalls or locks.
+*  The reader side has no dependencies besides libc, so agents only link interfaceTable.
+*  The header names the writer process, so readers can tell whether the table is still
+*  maintained and a second writer does not take over a region that is in use.
+*  Liveness checks assume readers and the writer share a pid namespace.
+*/
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#define IFTABLE_MAGIC               0x49464d54  /**< "IFMT" */
+#define IFTABLE_VERSION             2
+#define IFTABLE_DEFAULT_NAME        "/interfaceMonitor"
+#define IFTABLE_DEFAULT_CAPACITY    4096
+#define IFTABLE_ID_SIZE             128
+#define IFTABLE_NAME_SIZE           32
+#define IFTABLE_HWADDR_SIZE         32
+#define IFTABLE_READ_RETRIES        10000
+
+////////////////////////////////////////////////////////////
+///////           SharedInterfaceEntry            //////////
+////////////////////////////////////////////////////////////
+
+/**
+* @class SharedInterfaceEntry
+* @brief A fixed-size interface record as it is laid out in shared memory.
+*  Strings are always null-terminated, type holds an InterfaceType value
+*/
+
+struct SharedInterfaceEntry
+{
+    char id[IFTABLE_ID_SIZE];           /**< Backend device id, e.g. NM object path */
+    char name[IFTABLE_NAME_SIZE];
+    char hwAddr[IFTABLE_HWADDR_SIZE];
+    uint32_t type;
+
+    SharedInterfaceEntry();
+    SharedInterfaceEntry(const std::string& id, const std::string& name, const std::string& hwAddr, const uint32_t& type);
+};
+
+////////////////////////////////////////////////////////////
+///////           SharedTableHeader               //////////
+////////////////////////////////////////////////////////////
+
+/**
+* @class SharedTableHeader
+* @brief The header at the beginning of the region, followed by capacity entries
+*/
+
+struct SharedTableHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;                  /**< Max entries in the region */
+    uint32_t entrySize;                 /**< sizeof(SharedInterfaceEntry), checked by readers */
+    std::atomic<uint64_t> sequence;     /**< Seqlock counter, odd while the writer is updating */
+    std::atomic<uint32_t> closed;       /**< Set by the writer on shutdown, readers should reopen */
+    int32_t ownerPid;                   /**< The writer process */
+    uint64_t ownerStartTime;            /**< Its start time in clock ticks since boot, tells a reused pid apart */
+    uint32_t count;                     /**< Valid entries */
+    uint32_t overflow;                  /**< Entries that did not fit in the capacity */
+};
+
+////////////////////////////////////////////////////////////
+///////           SharedTableWriter               //////////
+////////////////////////////////////////////////////////////
+
+/**
+* @class SharedTableWriter
+* @brief Creates the shared memory region and publishes interface tables into it.
+*  There must be only one writer per region: the constructor throws if the region belongs
+*  to a live process and replaces a region left by a crashed or closed writer
+*/
+
+class SharedTableWriter
+{
+public:
+    SharedTableWriter(const std::string& shmName = IFTABLE_DEFAULT_NAME,
+                      const uint32_t& capacity = IFTABLE_DEFAULT_CAPACITY);
+    ~SharedTableWriter();
+
+    void publish(const std::vector<SharedInterfaceEntry>& entries);
+    uint64_t getSequence() const;
+
+private:
+    SharedTableWriter(const SharedTableWriter&);
+    SharedTableWriter& operator=(const SharedTableWriter&);
+
+private:
+    std::string mShmName;
+    size_t mSize;
+    SharedTableHeader* mHeader;
+    SharedInterfaceEntry* mEntries;
+};
+
+////////////////////////////////////////////////////////////
+///////           SharedTableReader               //////////
+////////////////////////////////////////////////////////////
+
+/**
+* @class SharedTableReader
+* @brief Maps an existing region read-only. Once constructed, read() performs
+*  no syscalls: it copies the table and retries if the writer interfered
+*/
+
+class SharedTableReader
+{
+public:
+    SharedTableReader(const std::string& shmName = IFTABLE_DEFAULT_NAME);
+    ~SharedTableReader();
+
+    /**< Copies a consistent snapshot. Returns false if the writer has closed the region
+         or kept it busy for IFTABLE_READ_RETRIES attempts */
+    bool read(std::vector<SharedInterfaceEntry>& entries, uint64_t* sequence = nullptr) const;
+    uint64_t getSequence() const;  /**< Cheap check whether the table has changed since the last read */
+    bool isClosed() const;
+
+    /**< False once the writer has closed the region or died without closing it, so the table is stale.
+         Unlike read() it performs syscalls, so it is meant to be checked periodically */
+    bool isWriterAlive() const;
+
+private:
+    SharedTableReader(const SharedTableReader&);
+    SharedTableReader& operator=(const SharedTableReader&);
+
+private:
+    size_t mSize;
+    const SharedTableHeader* mHeader;
+    const SharedInterfaceEntry* mEntries;
+};
+
+#endif // SHAREDINTERFACETABLE_H
@@ -14,13 +14,55 @@
 #include "boost/iostreams/device/null.hpp"
 #include <boost/chrono.hpp>
 
+#include <algorithm>
+#include <deque>
+#include <fcntl.h>
+#include <fstream>
+#include <future>
+#include <poll.h>
+#include <sstream>
 #include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
+#include "InterfaceSerializer.cpp"
 #include "InterfaceMonitor.cpp"
+#include "InterfaceServer.cpp"
+#include "BasicInterfaceManager.h"
+#include "InterfaceHistory.h"
+#include "InterfaceDetailsCache.h"
+#include "InterfaceManagerC.h"
 
 using boost::test_tools::output_test_stream;
 using namespace boost::iostreams;
 
+std::atomic<size_t> gAllocationCount(0);   /**< Global heap allocations, for the pooled dispatch check */
+
+void* operator new(std::size_t size)
+{
+    ++gAllocationCount;
+
+    void* pointer = malloc(size ? size : 1);
+    if(pointer == nullptr){
+        throw std::bad_alloc();
+    }
+
+    return pointer;
+}
+
+void operator delete(void* pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    free(pointer);
+}
+
 enum ArgsPos
 {
     ARG_IF_LIST_PATTERN_FILENAME = 1, //since 0th arg is the path to a binary file
@@ -150,4 +192,1228 @@ BOOST_FIXTURE_TEST_CASE( interface_add_remove_print_check, ArgsFixture )
     }
 }
 
+/**< Needs NetworkManager, like the print checks */
+BOOST_AUTO_TEST_CASE( nm_stop_start_check )
+{
+    ImplPtr impl = InterfaceManager::createImpl(BACKEND_NETWORK_MANAGER);
+
+    /**< A stop without a start in progress does not end the next run */
+    impl->stopListening();
+    std::future<void> listening = std::async(std::launch::async, [&impl](){ impl->startListening(); });
+    BOOST_CHECK(listening.wait_for(std::chrono::milliseconds(200)) == std::future_status::timeout);
+
+    impl->stopListening();
+    BOOST_REQUIRE(listening.wait_for(std::chrono::seconds(2)) == std::future_status::ready);
+
+    /**< A stop after a prepared start ends that run once it begins */
+    impl->prepareListening();
+    impl->stopListening();
+    listening = std::async(std::launch::async, [&impl](){ impl->startListening(); });
+    BOOST_REQUIRE(listening.wait_for(std::chrono::seconds(2)) == std::future_status::ready);
+}
+
+BOOST_AUTO_TEST_CASE( shared_table_publish_read_check )
+{
+    const std::string shmName = "/interfaceMonitorTests";
+
+    SharedTableWriter writer(shmName, 2);
+    SharedTableReader reader(shmName);
+
+    std::vector<SharedInterfaceEntry> entries;
+    entries.push_back(SharedInterfaceEntry("/dev/1", "eth0", "00:11:22:33:44:55", IF_TYPE_ETH));
+    entries.push_back(SharedInterfaceEntry("/dev/2", "test", "00:11:22:33:44:56", IF_TYPE_TUN));
+    entries.push_back(SharedInterfaceEntry("/dev/3", "lo", "", IF_TYPE_LO));
+    writer.publish(entries);
+
+    std::vector<SharedInterfaceEntry> snapshot;
+    uint64_t sequence = 0;
+
+    BOOST_CHECK(reader.read(snapshot, &sequence));
+    BOOST_CHECK_EQUAL(sequence, writer.getSequence());
+    BOOST_REQUIRE_EQUAL(snapshot.size(), 2); // capacity limits the table
+    BOOST_CHECK_EQUAL(std::string(snapshot[1].name), "test");
+    BOOST_CHECK_EQUAL(snapshot[1].type, IF_TYPE_TUN);
+
+    writer.publish(std::vector<SharedInterfaceEntry>());
+    BOOST_CHECK(reader.getSequence() != sequence);
+    BOOST_CHECK(reader.read(snapshot));
+    BOOST_CHECK(snapshot.empty());
+
+    /**< The region of a live writer is not taken over */
+    BOOST_CHECK(reader.isWriterAlive());
+    BOOST_CHECK_THROW(SharedTableWriter(shmName, 2), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( shared_table_owner_check )
+{
+    const std::string shmName = "/interfaceMonitorTestsOwner";
+
+    /**< A writer that dies without closing the region */
+    pid_t child = fork();
+    BOOST_REQUIRE(child >= 0);
+
+    if(child == 0)
+    {
+        new SharedTableWriter(shmName, 2);
+        _exit(0);
+    }
+
+    int status = 0;
+    waitpid(child, &status, 0);
+
+    {
+        SharedTableReader reader(shmName);
+        BOOST_CHECK(!reader.isClosed());
+        BOOST_CHECK(!reader.isWriterAlive());
+    }
+
+    SharedTableWriter writer(shmName, 2);
+    SharedTableReader reader(shmName);
+    BOOST_CHECK(reader.isWriterAlive());
+}
+
+BOOST_AUTO_TEST_CASE( timer_wheel_check )
+{
+    io_service eventLoop;
+    TimerWheel wheel(eventLoop, 1);
+    std::vector<uint32_t> fired;
+
+    /**< Delays cover the first level, cascading from higher levels and the same slot on different levels */
+    for(uint32_t delay : {300, 0, 70, 4100, 64, 5})
+    {
+        wheel.schedule(delay, [&fired, delay](){ fired.push_back(delay); });
+    }
+
+    TimerId cancelled = wheel.schedule(10, [&fired](){ fired.push_back(10); });
+    BOOST_CHECK(wheel.cancel(cancelled));
+    BOOST_CHECK(!wheel.cancel(cancelled));
+    BOOST_CHECK_EQUAL(wheel.size(), 6);
+
+    eventLoop.run();
+
+    std::vector<uint32_t> expected = {0, 5, 64, 70, 300, 4100};
+    BOOST_CHECK(fired == expected);
+    BOOST_CHECK_EQUAL(wheel.size(), 0);
+
+    /**< The timer only wakes up to cascade and expire the task, not on every tick */
+    eventLoop.reset();
+    wheel.schedule(200, [&fired](){ fired.push_back(200); });
+    BOOST_CHECK(eventLoop.run() <= 4);
+    BOOST_CHECK_EQUAL(fired.back(), 200);
+
+    /**< A short task scheduled later must not step over the cascade of a longer one */
+    eventLoop.reset();
+    fired.clear();
+
+    const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    wheel.schedule(9, [&fired](){ fired.push_back(9); });
+    wheel.schedule(65, [&fired](){ fired.push_back(65); });
+    wheel.schedule(15, [&](){ wheel.schedule(55, [&fired](){ fired.push_back(70); }); });
+    eventLoop.run();
+
+    expected = {9, 65, 70};
+    BOOST_CHECK(fired == expected);
+    BOOST_CHECK((boost::posix_time::microsec_clock::universal_time() - start).total_milliseconds() < 1000);
+}
+
+/**< A backend that only rereads devices, with scripted results */
+class ScriptedImpl : public AbstractInterfaceManagerImpl
+{
+public:
+    void startListening() override {}
+    void stopListening() override {}
+    void updateDevices() override {}
+
+    bool updateDevice(const std::string&) override
+    {
+        bool result = results.empty() || results.front();
+        if(!results.empty()){
+            results.pop_front();
+        }
+
+        calls.push_back(boost::posix_time::microsec_clock::universal_time());
+        thread = boost::this_thread::get_id();
+
+        if(onCall){
+            onCall();
+        }
+
+        return result;
+    }
+
+    std::deque<bool> results;
+    std::vector<boost::posix_time::ptime> calls;
+    boost::thread::id thread;                   /**< Of the last call */
+    std::function<void ()> onCall;
+};
+
+BOOST_AUTO_TEST_CASE( refresh_backoff_check )
+{
+    io_service eventLoop;
+    ScriptedImpl* impl = new ScriptedImpl;
+    InterfaceManager manager(eventLoop, ImplPtr(impl));
+
+    /**< Failures double the period, a success restores it */
+    impl->results = {true, false, false, false, true, true};
+    impl->onCall = [&](){ if(impl->calls.size() == 6) eventLoop.stop(); };
+
+    const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    manager.setRefreshPeriod("/dev/1", 20);
+    eventLoop.run();
+    eventLoop.reset();
+
+    BOOST_REQUIRE_EQUAL(impl->calls.size(), 6);
+    BOOST_CHECK(impl->thread != boost::this_thread::get_id());    // rereads are kept off the event loop
+
+    const std::vector<long> expected = {20, 20, 40, 80, 160, 20};
+    boost::posix_time::ptime previous = start;
+
+    for(size_t i = 0; i < expected.size(); ++i)
+    {
+        long interval = (impl->calls[i] - previous).total_milliseconds();
+        BOOST_CHECK_MESSAGE(interval >= expected[i] - TIMER_WHEEL_TICK_MSEC && interval < expected[i] + 100,
+                            "refresh " << i << " after " << interval << " msec");
+        previous = impl->calls[i];
+    }
+
+    /**< A zero period stops refreshing */
+    manager.setRefreshPeriod("/dev/1", 0);
+
+    deadline_timer timeout(eventLoop, msec(100));
+    timeout.async_wait([&eventLoop](const boost::system::error_code&){ eventLoop.stop(); });
+    eventLoop.run();
+
+    BOOST_CHECK_EQUAL(impl->calls.size(), 6);
+}
+
+class IdleImpl final : public AbstractInterfaceManagerImpl
+{
+public:
+    void startListening() override {}
+    void stopListening() override {}
+    void updateDevices() override {}
+    bool updateDevice(const std::string&) override { return true; }
+
+    using AbstractInterfaceManagerImpl::reportUpdate;
+
+    void numberedUpdate(InterfaceInfo info, const bool& action)
+    {
+        unique_lock lock(mMutex);
+        stampUpdate(info, action);
+        reportUpdate(info, action);
+    }
+
+    void skip(const std::string& deviceId)
+    {
+        unique_lock lock(mMutex);
+        skipUpdate(deviceId);
+    }
+};
+
+struct PooledEventCounter
+{
+    size_t added = 0;
+    size_t removed = 0;
+    std::string lastName;
+
+    void onInterfaceEvent(const InterfaceEvent& event)
+    {
+        event.action ? ++added : ++removed;
+
+        if(lastName != event.name){
+            lastName = event.name;
+        }
+    }
+
+    void onUpdateFailed(){}
+};
+
+BOOST_AUTO_TEST_CASE( pooled_dispatch_allocation_check )
+{
+    io_service eventLoop;
+    PooledEventCounter handler;
+    BasicInterfaceManager<IdleImpl, PooledEventCounter, PooledDispatch> manager(eventLoop, handler);
+
+    InterfaceInfo info;
+    info.id = "/org/freedesktop/NetworkManager/Devices/42";
+    info.name = "enp0s31f6";
+    info.hwAddr = "00:11:22:33:44:55";
+    info.type = IF_TYPE_ETH;
+
+    auto emitUpdates = [&](const size_t& count)
+    {
+        for(size_t i = 0; i < count; ++i){
+            manager.getBackend().reportUpdate(info, i % 2 == 0);
+        }
+
+        eventLoop.poll();
+        eventLoop.reset();
+    };
+
+    emitUpdates(64); // warm up
+
+    size_t allocations = gAllocationCount;
+    emitUpdates(1000);
+    allocations = gAllocationCount - allocations;
+
+    BOOST_CHECK_EQUAL(allocations, 0);
+    BOOST_CHECK_EQUAL(handler.added, 532);
+    BOOST_CHECK_EQUAL(handler.removed, 532);
+    BOOST_CHECK_EQUAL(handler.lastName, info.name);
+
+    PooledDispatch& dispatch = manager.getDispatch();
+    BOOST_CHECK_EQUAL(dispatch.getPool().available(), dispatch.getPool().capacity());
+    BOOST_CHECK_EQUAL(dispatch.getOverflowCount(), 0);
+
+    /**< Strings longer than the inline storage are cut */
+    InterfaceEvent event;
+    info.name = std::string(EVENT_NAME_SIZE * 2, 'x');
+    event.assign(info, true);
+    BOOST_CHECK(event.truncated);
+    BOOST_CHECK_EQUAL(strlen(event.name), EVENT_NAME_SIZE - 1);
+}
+
+BOOST_AUTO_TEST_CASE( skipped_update_check )
+{
+    io_service eventLoop;
+    PooledEventCounter handler;
+    BasicInterfaceManager<IdleImpl, PooledEventCounter, PooledDispatch> manager(eventLoop, handler);
+    IdleImpl& backend = manager.getBackend();
+
+    InterfaceInfo info;
+    info.id = "/dev/1";
+
+    backend.numberedUpdate(info, true);
+    backend.skip(info.id);
+    backend.numberedUpdate(info, false);
+    BOOST_CHECK_EQUAL(manager.getSkippedUpdateCount(), 1);
+    BOOST_CHECK_EQUAL(manager.getLostUpdateCount(), 0);
+
+    info.sequence = backend.getSequence() + 2;                      // one update is lost on the way
+    backend.reportUpdate(info, true);
+    BOOST_CHECK_EQUAL(manager.getSkippedUpdateCount(), 1);
+    BOOST_CHECK_EQUAL(manager.getLostUpdateCount(), 1);
+
+    eventLoop.poll();
+}
+
+/**< Checks updates the way a pooled consumer would, from the event alone */
+struct PooledEventTracker
+{
+    UpdateTracker tracker;
+    std::vector<UpdateState> states;
+    uint64_t lastSequence = 0;
+    size_t sequenceGaps = 0;
+
+    void onInterfaceEvent(const InterfaceEvent& event)
+    {
+        if(event.sequence != lastSequence + 1){
+            ++sequenceGaps;
+        }
+
+        lastSequence = event.sequence;
+        states.push_back(tracker.track(event.toInfo(), event.action));
+    }
+
+    void onUpdateFailed(){}
+};
+
+BOOST_AUTO_TEST_CASE( pooled_gap_detection_check )
+{
+    io_service eventLoop;
+    PooledEventTracker handler;
+    BasicInterfaceManager<IdleImpl, PooledEventTracker, PooledDispatch> manager(eventLoop, handler);
+    IdleImpl& backend = manager.getBackend();
+
+    InterfaceInfo info;
+    info.id = "/dev/1";
+    info.name = "eth0";
+
+    info.sequence = 1;
+    info.generation = 1;
+    backend.reportUpdate(info, true);
+    info.sequence = 2;
+    backend.reportUpdate(info, false);
+    eventLoop.poll();
+    eventLoop.reset();
+
+    BOOST_CHECK_EQUAL(handler.lastSequence, 2);
+    BOOST_CHECK_EQUAL(handler.sequenceGaps, 0);
+
+    /**< The addition before this removal is lost */
+    info.sequence = 4;
+    info.generation = 5;
+    backend.reportUpdate(info, false);
+    eventLoop.poll();
+
+    std::vector<UpdateState> expected = {UPDATE_IN_ORDER, UPDATE_IN_ORDER, UPDATE_GAP};
+    BOOST_CHECK(handler.states == expected);
+    BOOST_CHECK_EQUAL(handler.sequenceGaps, 1);
+}
+
+void writeSysfsAttribute(const std::string& path, const std::string& value)
+{
+    std::ofstream attribute(path.c_str());
+    attribute<<value<<std::endl;
+}
+
+void addSysfsInterface(const std::string& root, const std::string& name, const std::string& type,
+                       const std::string& address, const std::string& uevent = "")
+{
+    const std::string device = root + "/devices/" + name;
+    mkdir(device.c_str(), 0755);
+
+    writeSysfsAttribute(device + "/type", type);
+    writeSysfsAttribute(device + "/address", address);
+    writeSysfsAttribute(device + "/uevent", uevent + "INTERFACE=" + name);
+
+    symlink(device.c_str(), (root + "/net/" + name).c_str());
+}
+
+/**< A scratch sysfs tree: interfaces are linked from net to devices, removed with the test */
+struct SysfsFixture
+{
+    SysfsFixture()
+    {
+        char rootTemplate[] = "/tmp/interfaceMonitorSysfsXXXXXX";
+        BOOST_REQUIRE(mkdtemp(rootTemplate) != nullptr);
+
+        root = rootTemplate;
+        net = root + "/net";
+        mkdir((root + "/devices").c_str(), 0755);
+        mkdir(net.c_str(), 0755);
+    }
+
+    ~SysfsFixture()
+    {
+        if(!root.empty()){
+            system(("rm -rf " + root).c_str());
+        }
+    }
+
+    std::string root;
+    std::string net;
+};
+
+BOOST_FIXTURE_TEST_CASE( sysfs_backend_check, SysfsFixture )
+{
+    addSysfsInterface(root, "eth0", "1", "00:11:22:aa:bb:cc");
+    addSysfsInterface(root, "lo", "772", "00:00:00:00:00:00");
+    addSysfsInterface(root, "eth0.5", "1", "00:11:22:aa:bb:cc", "DEVTYPE=vlan\n");
+    writeSysfsAttribute(net + "/bonding_masters", "");
+
+    SysfsInterfaceManagerImpl impl(net, 10);
+    impl.updateDevices();
+
+    InterfaceInfoStorage data = impl.getInterfacesData();
+    BOOST_REQUIRE_EQUAL(data.size(), 3);
+    BOOST_CHECK_EQUAL(data[net + "/eth0"].name, "eth0");
+    BOOST_CHECK_EQUAL(data[net + "/eth0"].hwAddr, "00:11:22:AA:BB:CC");
+    BOOST_CHECK_EQUAL(data[net + "/eth0"].type, IF_TYPE_ETH);
+    BOOST_CHECK_EQUAL(data[net + "/eth0.5"].type, IF_TYPE_TUN);
+    BOOST_CHECK_EQUAL(data[net + "/lo"].type, IF_TYPE_LO);
+    BOOST_CHECK(data[net + "/lo"].hwAddr.empty());
+
+    std::vector<std::string> updates;
+    impl.interfaceListUpdateSignal.connect([&updates](const InterfaceInfo& info, const bool& action)
+    {
+        updates.push_back((action ? "+" : "-") + info.name + " " + info.hwAddr);
+    });
+
+    impl.poll();
+    BOOST_CHECK(updates.empty());
+
+    /**< Additions are reported while listing, removals afterwards */
+    addSysfsInterface(root, "test", "1", "00:11:22:33:44:56");
+    unlink((net + "/lo").c_str());
+    impl.poll();
+    BOOST_CHECK(updates == std::vector<std::string>({"+test 00:11:22:33:44:56", "-lo "}));
+
+    /**< A netdev registered again under the same name gets a new entry. Renaming a new link
+         over the old one makes sure the test filesystem does not reuse the inode */
+    updates.clear();
+    symlink((root + "/devices/eth0").c_str(), (root + "/eth0").c_str());
+    rename((root + "/eth0").c_str(), (net + "/eth0").c_str());
+    impl.poll();
+    BOOST_CHECK(updates == std::vector<std::string>({"-eth0 00:11:22:AA:BB:CC", "+eth0 00:11:22:AA:BB:CC"}));
+
+    /**< Address changes are found by targeted updates */
+    updates.clear();
+    BOOST_CHECK(impl.updateDevice(net + "/eth0"));
+    BOOST_CHECK(updates.empty());
+
+    writeSysfsAttribute(root + "/devices/eth0/address", "00:11:22:aa:bb:cd");
+    BOOST_CHECK(impl.updateDevice(net + "/eth0"));
+    BOOST_CHECK(updates == std::vector<std::string>({"-eth0 00:11:22:AA:BB:CC", "+eth0 00:11:22:AA:BB:CD"}));
+    BOOST_CHECK(impl.updateDevice(net + "/lo"));       // a vanished device is up to date
+    BOOST_CHECK(!impl.updateDevice("/elsewhere/eth0"));
+}
+
+BOOST_FIXTURE_TEST_CASE( stop_start_check, SysfsFixture )
+{
+    io_service eventLoop;
+    InterfaceManager manager(eventLoop, ImplPtr(new SysfsInterfaceManagerImpl(net, 10)));
+    manager.updateDevices();
+
+    std::vector<std::string> updates;
+    manager.interfaceUpdateSignal.connect([&](const InterfaceInfo& info, const bool& action)
+    {
+        updates.push_back((action? "+" : "-") + info.name);
+        eventLoop.stop();
+    });
+
+    auto waitForUpdate = [&eventLoop]()
+    {
+        deadline_timer timeout(eventLoop, msec(2000));
+        timeout.async_wait([&eventLoop](const boost::system::error_code& error)
+        {
+            if(!error){
+                eventLoop.stop();
+            }
+        });
+
+        eventLoop.run();
+        eventLoop.reset();
+    };
+
+    /**< Stops without a start in progress are not remembered */
+    manager.stopListening();
+    manager.startListening();
+    addSysfsInterface(root, "test", "1", "00:11:22:33:44:56");
+    waitForUpdate();
+    BOOST_CHECK(updates == std::vector<std::string>({"+test"}));
+
+    manager.stopListening();
+    manager.stopListening();
+    manager.startListening();
+    unlink((net + "/test").c_str());
+    waitForUpdate();
+    BOOST_CHECK(updates == std::vector<std::string>({"+test", "-test"}));
+
+    /**< A stop right after a start ends that start, but not the one after it */
+    manager.stopListening();
+    manager.startListening();
+    manager.stopListening();
+    manager.startListening();
+    addSysfsInterface(root, "test", "1", "00:11:22:33:44:56");
+    waitForUpdate();
+    BOOST_CHECK(updates == std::vector<std::string>({"+test", "-test", "+test"}));
+}
+
+BOOST_AUTO_TEST_CASE( update_tracker_check )
+{
+    InterfaceInfo info;
+    info.id = "/dev/1";
+    info.generation = 2;
+
+    InterfaceInfoStorage snapshot;
+    snapshot[info.id] = info;
+
+    UpdateTracker tracker;
+    tracker.reset(snapshot);
+
+    BOOST_CHECK_EQUAL(tracker.track(info, true), UPDATE_STALE);      // emitted before the snapshot
+    BOOST_CHECK_EQUAL(tracker.track(info, false), UPDATE_IN_ORDER);
+    BOOST_CHECK_EQUAL(tracker.track(info, false), UPDATE_STALE);
+
+    info.generation = 4;                                             // other devices have taken generation 3
+    BOOST_CHECK_EQUAL(tracker.track(info, true), UPDATE_IN_ORDER);
+    info.generation = 6;                                             // the removal of generation 4 is lost
+    BOOST_CHECK_EQUAL(tracker.track(info, true), UPDATE_GAP);
+    BOOST_CHECK_EQUAL(tracker.track(info, false), UPDATE_IN_ORDER);
+
+    info.id = "/dev/2";                                              // unknown devices start at any generation
+    BOOST_CHECK_EQUAL(tracker.track(info, true), UPDATE_IN_ORDER);
+    info.generation = 8;                                             // the addition of generation 8 is lost
+    BOOST_CHECK_EQUAL(tracker.track(info, false), UPDATE_GAP);
+}
+
+BOOST_FIXTURE_TEST_CASE( update_sequence_resync_check, SysfsFixture )
+{
+    addSysfsInterface(root, "eth0", "1", "00:11:22:aa:bb:cc");
+
+    io_service eventLoop;
+    SysfsInterfaceManagerImpl* impl = new SysfsInterfaceManagerImpl(net, 10);
+    InterfaceManager manager(eventLoop, ImplPtr(impl));
+    manager.updateDevices();
+    BOOST_CHECK_EQUAL(manager.getInterfaceData()[net + "/eth0"].generation, 1);
+
+    std::vector<InterfaceInfo> updates;
+    manager.interfaceUpdateSignal.connect([&updates](const InterfaceInfo& info, const bool&){ updates.push_back(info); });
+
+    addSysfsInterface(root, "test", "1", "00:11:22:33:44:56");
+    impl->poll();
+    unlink((net + "/test").c_str());
+    impl->poll();
+    eventLoop.poll();
+    eventLoop.reset();
+
+    BOOST_REQUIRE_EQUAL(updates.size(), 2);
+    BOOST_CHECK_EQUAL(updates[0].sequence, 1);
+    BOOST_CHECK_EQUAL(updates[1].sequence, 2);
+    BOOST_CHECK_EQUAL(updates[0].generation, 2);                    // generations are shared with eth0
+    BOOST_CHECK_EQUAL(updates[1].generation, 2);
+
+    /**< A resync reports the change through the usual updates, then the current info to the requester */
+    updates.clear();
+    writeSysfsAttribute(root + "/devices/eth0/address", "00:11:22:aa:bb:cd");
+
+    InterfaceInfo resynced;
+    bool present = false;
+    manager.resyncDevice(net + "/eth0", [&](const InterfaceInfo& info, const bool& isPresent)
+    {
+        resynced = info;
+        present = isPresent;
+        eventLoop.stop();
+    });
+    eventLoop.run();
+
+    BOOST_REQUIRE_EQUAL(updates.size(), 2);
+    BOOST_CHECK_EQUAL(updates[1].generation, 3);
+    BOOST_CHECK_EQUAL(updates[1].sequence, 4);
+    BOOST_CHECK(present);
+    BOOST_CHECK_EQUAL(resynced.hwAddr, "00:11:22:AA:BB:CD");
+    BOOST_CHECK_EQUAL(resynced.generation, 3);
+    BOOST_CHECK_EQUAL(manager.getLostUpdateCount(), 0);
+}
+
+BOOST_FIXTURE_TEST_CASE( pause_resume_check, SysfsFixture )
+{
+    addSysfsInterface(root, "eth0", "1", "00:11:22:aa:bb:cc");
+
+    io_service eventLoop;
+    SysfsInterfaceManagerImpl* impl = new SysfsInterfaceManagerImpl(net, 10);
+    InterfaceManager manager(eventLoop, ImplPtr(impl));
+    manager.updateDevices();
+
+    std::map<std::string, std::vector<bool>> updates;
+    manager.interfaceUpdateSignal.connect([&updates](const InterfaceInfo& info, const bool& action){ updates[info.name].push_back(action); });
+
+    manager.pause();
+    BOOST_CHECK(manager.isPaused());
+
+    addSysfsInterface(root, "test", "1", "00:11:22:33:44:56");
+    impl->poll();
+    unlink((net + "/eth0").c_str());
+    impl->poll();
+    addSysfsInterface(root, "test2", "1", "00:11:22:33:44:57");
+    impl->poll();
+    unlink((net + "/test2").c_str());
+    impl->poll();
+
+    eventLoop.poll();
+    eventLoop.reset();
+    BOOST_CHECK(updates.empty());
+    BOOST_CHECK_EQUAL(manager.getInterfaceData().size(), 1);
+
+    /**< Only the difference is delivered, test2 came and went unnoticed */
+    manager.resume();
+    eventLoop.poll();
+    eventLoop.reset();
+
+    BOOST_CHECK(!manager.isPaused());
+    BOOST_REQUIRE_EQUAL(updates.size(), 2);
+    BOOST_CHECK(updates["eth0"] == std::vector<bool>{false});
+    BOOST_CHECK(updates["test"] == std::vector<bool>{true});
+
+    updates.clear();
+    unlink((net + "/test").c_str());
+    impl->poll();
+    eventLoop.poll();
+    BOOST_CHECK(updates["test"] == std::vector<bool>{false});
+}
+
+BOOST_FIXTURE_TEST_CASE( monitor_line_cache_check, SysfsFixture )
+{
+    addSysfsInterface(root, "eth0", "1", "00:11:22:aa:bb:cc");
+    addSysfsInterface(root, "lo", "772", "00:00:00:00:00:00");
+
+    io_service eventLoop;
+    std::ostringstream updates;
+    SysfsInterfaceManagerImpl* impl = new SysfsInterfaceManagerImpl(net, 100000);
+    InterfaceMonitor monitor(eventLoop, 0, ImplPtr(impl), &updates);
+    monitor.start();
+
+    OutputFormat format = FORMAT_TEXT;
+    auto dump = [&]()
+    {
+        std::ostringstream output;
+        monitor.setOutputStream(&output);
+        monitor.printInterfaces();
+        monitor.setOutputStream(&updates);
+        return output.str();
+    };
+
+    /**< Every dump must match a fresh serialization of the backend table */
+    auto serialize = [&]()
+    {
+        std::string lines;
+        for(auto& interface : impl->getInterfacesData()){
+            lines += InterfaceSerializer::serializeListEntry(interface.second, format) + "\n";
+        }
+        return lines;
+    };
+
+    auto apply = [&]()
+    {
+        eventLoop.poll();
+        eventLoop.reset();
+    };
+
+    BOOST_CHECK_EQUAL(dump(), serialize());
+    BOOST_CHECK_EQUAL(dump(), serialize());
+
+    addSysfsInterface(root, "test", "1", "00:11:22:33:44:56");
+    impl->poll();
+    apply();
+    BOOST_CHECK(dump().find("IFACE test 00:11:22:33:44:56") != std::string::npos);
+    BOOST_CHECK_EQUAL(dump(), serialize());
+
+    writeSysfsAttribute(root + "/devices/test/address", "00:11:22:33:44:57");
+    BOOST_CHECK(impl->updateDevice(net + "/test"));
+    apply();
+    BOOST_CHECK_EQUAL(dump(), serialize());
+
+    unlink((net + "/eth0").c_str());
+    impl->poll();
+    apply();
+    BOOST_CHECK(dump().find("eth0") == std::string::npos);
+    BOOST_CHECK_EQUAL(dump(), serialize());
+
+    /**< A format change reseeds the cache */
+    format = FORMAT_JSON;
+    monitor.setOutputFormat(format);
+    BOOST_CHECK_EQUAL(dump(), serialize());
+
+    unlink((net + "/lo").c_str());
+    impl->poll();
+    apply();
+    BOOST_CHECK_EQUAL(dump(), serialize());
+
+    const std::string printed = updates.str();
+    BOOST_CHECK_EQUAL(std::count(printed.begin(), printed.end(), '\n'), 5);
+    monitor.stop();
+}
+
+BOOST_FIXTURE_TEST_CASE( details_cache_check, SysfsFixture )
+{
+    addSysfsInterface(root, "eth0", "1", "00:11:22:aa:bb:cc");
+    writeSysfsAttribute(root + "/devices/eth0/mtu", "1500");
+    writeSysfsAttribute(root + "/devices/eth0/speed", "1000");
+    mkdir((root + "/devices/eth0/device").c_str(), 0755);
+    symlink((root + "/drivers/e1000e").c_str(), (root + "/devices/eth0/device/driver").c_str());
+    symlink("../br0", (root + "/devices/eth0/master").c_str());
+
+    addSysfsInterface(root, "eth0.5", "1", "00:11:22:aa:bb:cc", "DEVTYPE=vlan\n");
+    writeSysfsAttribute(root + "/devices/eth0.5/mtu", "1496");
+    symlink("../eth0", (root + "/devices/eth0.5/lower_eth0").c_str());
+
+    std::vector<InterfaceInfo> interfaces(3);
+    interfaces[0].id = "/dev/1";
+    interfaces[0].name = "eth0";
+    interfaces[1].id = "/dev/2";
+    interfaces[1].name = "eth0.5";
+    interfaces[2].id = "/dev/3";
+    interfaces[2].name = "gone";
+
+    InterfaceDetailsCache cache(net);
+    auto fetch = [&cache](const std::vector<InterfaceInfo>& interfaces)
+    {
+        std::promise<std::vector<InterfaceDetailsPtr>> details;
+        cache.fetch(interfaces, [&details](const std::vector<InterfaceDetailsPtr>& resolved){ details.set_value(resolved); });
+        return details.get_future().get();
+    };
+
+    std::vector<InterfaceDetailsPtr> details = fetch(interfaces);
+    BOOST_REQUIRE_EQUAL(details.size(), 3);
+    BOOST_REQUIRE(details[0] != nullptr && details[1] != nullptr);
+    BOOST_CHECK(details[2] == nullptr);
+
+    BOOST_CHECK_EQUAL(details[0]->mtu, 1500);
+    BOOST_CHECK_EQUAL(details[0]->speedMbps, 1000);
+    BOOST_CHECK_EQUAL(details[0]->driver, "e1000e");
+    BOOST_CHECK_EQUAL(details[0]->master, "br0");
+    BOOST_CHECK(details[0]->parent.empty());
+
+    BOOST_CHECK_EQUAL(details[1]->mtu, 1496);
+    BOOST_CHECK_EQUAL(details[1]->speedMbps, -1);
+    BOOST_CHECK_EQUAL(details[1]->parent, "eth0");
+    BOOST_CHECK(details[1]->driver.empty());
+
+    /**< Cached until invalidated */
+    writeSysfsAttribute(root + "/devices/eth0/mtu", "9000");
+    BOOST_CHECK(cache.getCached("/dev/1") == details[0]);
+    BOOST_CHECK_EQUAL(fetch(std::vector<InterfaceInfo>(1, interfaces[0])).front()->mtu, 1500);
+
+    cache.invalidate("/dev/1");
+    BOOST_CHECK(cache.getCached("/dev/1") == nullptr);
+    BOOST_CHECK_EQUAL(fetch(std::vector<InterfaceInfo>(1, interfaces[0])).front()->mtu, 9000);
+}
+
+BOOST_FIXTURE_TEST_CASE( details_batching_check, SysfsFixture )
+{
+    addSysfsInterface(root, "eth0", "1", "00:11:22:aa:bb:cc");
+    writeSysfsAttribute(root + "/devices/eth0/mtu", "1500");
+    addSysfsInterface(root, "eth1", "1", "00:11:22:aa:bb:cd");
+    writeSysfsAttribute(root + "/devices/eth1/mtu", "1500");
+
+    /**< Reading the mtu of slow blocks the worker until the test writes it */
+    addSysfsInterface(root, "slow", "1", "00:11:22:aa:bb:ce");
+    const std::string slowMtu = root + "/devices/slow/mtu";
+    BOOST_REQUIRE_EQUAL(mkfifo(slowMtu.c_str(), 0644), 0);
+
+    std::vector<InterfaceInfo> interfaces(3);
+    interfaces[0].id = "/dev/0";
+    interfaces[0].name = "eth0";
+    interfaces[1].id = "/dev/1";
+    interfaces[1].name = "eth1";
+    interfaces[2].id = "/dev/2";
+    interfaces[2].name = "slow";
+
+    typedef std::vector<InterfaceDetailsPtr> DetailsList;
+    std::promise<DetailsList> first, joined, later;
+
+    InterfaceDetailsCache cache(net);
+    cache.fetch({interfaces[0], interfaces[2]}, [&first](const DetailsList& details){ first.set_value(details); });
+
+    /**< The pass has begun once the worker opens the pipe */
+    int writer = -1;
+    for(int i = 0; i < 200 && writer < 0; ++i)
+    {
+        writer = open(slowMtu.c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+        if(writer < 0){
+            usleep(10000);
+        }
+    }
+
+    BOOST_REQUIRE(writer >= 0);
+
+    /**< Requests made meanwhile share the next pass. A separate pass for the second
+         one would reread eth1 after the first callback has changed it */
+    cache.fetch({interfaces[1]}, [&](const DetailsList& details)
+    {
+        writeSysfsAttribute(root + "/devices/eth1/mtu", "9000");
+        cache.invalidate(interfaces[1].id);
+        joined.set_value(details);
+    });
+    cache.fetch({interfaces[1], interfaces[0]}, [&later](const DetailsList& details){ later.set_value(details); });
+
+    /**< Only the device invalidated during the pass is left uncached */
+    cache.invalidate(interfaces[2].id);
+    BOOST_REQUIRE_EQUAL(::write(writer, "1400\n", 5), 5);
+    ::close(writer);
+
+    DetailsList details = first.get_future().get();
+    BOOST_REQUIRE(details[0] != nullptr && details[1] != nullptr);
+    BOOST_CHECK_EQUAL(details[1]->mtu, 1400);
+    BOOST_CHECK(cache.getCached(interfaces[0].id) == details[0]);
+    BOOST_CHECK(cache.getCached(interfaces[2].id) == nullptr);
+
+    DetailsList joinedDetails = joined.get_future().get();
+    DetailsList laterDetails = later.get_future().get();
+    BOOST_REQUIRE(joinedDetails[0] != nullptr && laterDetails[0] != nullptr);
+    BOOST_CHECK(laterDetails[0] == joinedDetails[0]);
+    BOOST_CHECK_EQUAL(laterDetails[0]->mtu, 1500);
+    BOOST_CHECK(laterDetails[1] == details[0]);
+}
+
+/**< Loses every update and reports a device only when it is reread */
+class RereadImpl final : public AbstractInterfaceManagerImpl
+{
+public:
+    void startListening() override {}
+    void stopListening() override {}
+    void updateDevices() override {}
+
+    bool updateDevice(const std::string& deviceId) override
+    {
+        unique_lock lock(mMutex);
+        rereadThread = boost::this_thread::get_id();
+
+        InterfaceInfo info;
+        info.id = deviceId;
+        info.name = "reread";
+        stampUpdate(info, true);
+        reportUpdate(info, true);
+
+        return true;
+    }
+
+    void skip(const std::string& deviceId)
+    {
+        unique_lock lock(mMutex);
+        skipUpdate(deviceId);
+    }
+
+    boost::thread::id rereadThread;
+};
+
+BOOST_FIXTURE_TEST_CASE( c_api_check, SysfsFixture )
+{
+    char error[128] = "";
+    BOOST_CHECK(ifmon_create("unknown", 0, error, sizeof(error)) == nullptr);
+    BOOST_CHECK_EQUAL(std::string(error), "Unknown backend unknown");
+
+    addSysfsInterface(root, "eth0", "1", "00:11:22:aa:bb:cc");
+
+    ifmon_manager* manager = ifmonCreate(ImplPtr(new SysfsInterfaceManagerImpl(net, 10)), 4);
+    BOOST_REQUIRE(manager != nullptr);
+    BOOST_CHECK_EQUAL(ifmon_update(manager), 0);
+
+    ifmon_event events[4];
+    BOOST_REQUIRE_EQUAL(ifmon_snapshot(manager, events, 4), 1);
+    BOOST_CHECK_EQUAL(std::string(events[0].name), "eth0");
+    BOOST_CHECK_EQUAL(std::string(events[0].hw_addr), "00:11:22:AA:BB:CC");
+    BOOST_CHECK_EQUAL(events[0].generation, 1);
+
+    pollfd ready;
+    ready.fd = ifmon_fd(manager);
+    ready.events = POLLIN;
+    BOOST_CHECK_EQUAL(poll(&ready, 1, 0), 0);
+
+    BOOST_CHECK_EQUAL(ifmon_start(manager), 0);
+    addSysfsInterface(root, "test", "1", "00:11:22:33:44:56");
+    unlink((net + "/eth0").c_str());
+
+    /**< The backend may see both changes in one scan or in two */
+    std::vector<ifmon_event> drained;
+    while(drained.size() < 2 && poll(&ready, 1, 2000) == 1)
+    {
+        size_t count = ifmon_drain(manager, events, 4);
+        drained.insert(drained.end(), events, events + count);
+    }
+
+    BOOST_REQUIRE_EQUAL(drained.size(), 2);
+    BOOST_CHECK_EQUAL(poll(&ready, 1, 0), 0);
+    BOOST_CHECK_EQUAL(ifmon_dropped(manager), 0);
+
+    std::map<std::string, uint32_t> actions;
+    for(auto& event : drained){
+        actions[event.name] = event.action;
+    }
+
+    BOOST_CHECK_EQUAL(actions["test"], IFMON_ACTION_ADDED);
+    BOOST_CHECK_EQUAL(actions["eth0"], IFMON_ACTION_REMOVED);
+
+    ifmon_stop(manager);
+    ifmon_destroy(manager);
+
+    /**< Lost updates are reread on the worker, only the result reaches the ring */
+    RereadImpl* rereadImpl = new RereadImpl;
+    manager = ifmonCreate(ImplPtr(rereadImpl), 4);
+    ready.fd = ifmon_fd(manager);
+
+    rereadImpl->skip("/dev/1");
+    BOOST_REQUIRE_EQUAL(poll(&ready, 1, 2000), 1);
+    BOOST_REQUIRE_EQUAL(ifmon_drain(manager, events, 4), 1);
+    BOOST_CHECK_EQUAL(std::string(events[0].name), "reread");
+    BOOST_CHECK(rereadImpl->rereadThread != boost::this_thread::get_id());
+    BOOST_CHECK_EQUAL(ifmon_failures(manager), 0);
+
+    ifmon_destroy(manager);
+}
+
+/**< A blocking line client of InterfaceServer */
+struct LineClient
+{
+    explicit LineClient(const std::string& path) :
+        fd(socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)),
+        closed(false)
+    {
+        sockaddr_un address = sockaddr_un();
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+        BOOST_REQUIRE(connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+    }
+
+    ~LineClient()
+    {
+        ::close(fd);
+    }
+
+    void send(const std::string& data)
+    {
+        BOOST_REQUIRE_EQUAL(::write(fd, data.data(), data.size()), static_cast<ssize_t>(data.size()));
+    }
+
+    /**< Returns false on timeout or once the server has closed the connection */
+    bool readLine(std::string& line, const int& timeoutMsec = 2000)
+    {
+        size_t end = 0;
+        while((end = buffer.find('\n')) == std::string::npos)
+        {
+            pollfd ready = {fd, POLLIN, 0};
+            if(poll(&ready, 1, timeoutMsec) != 1){
+                return false;
+            }
+
+            char data[4096];
+            ssize_t size = ::read(fd, data, sizeof(data));
+            if(size <= 0)
+            {
+                closed = true;
+                return false;
+            }
+
+            buffer.append(data, size);
+        }
+
+        line = buffer.substr(0, end);
+        buffer.erase(0, end + 1);
+        return true;
+    }
+
+    /**< The lines of a reply without the closing END, which must follow */
+    std::vector<std::string> readReply()
+    {
+        std::vector<std::string> lines;
+        std::string line;
+
+        while(readLine(line) && line != SERVER_SNAPSHOT_END){
+            lines.push_back(line);
+        }
+
+        BOOST_CHECK_EQUAL(line, SERVER_SNAPSHOT_END);
+        return lines;
+    }
+
+    int fd;
+    std::string buffer;
+    bool closed;
+};
+
+BOOST_FIXTURE_TEST_CASE( server_check, SysfsFixture )
+{
+    addSysfsInterface(root, "eth0", "1", "00:11:22:aa:bb:cc");
+    const std::string socketPath = root + "/server.sock";
+
+    /**< A socket file nobody accepts on is left by a crashed server and replaced */
+    sockaddr_un address = sockaddr_un();
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    int stale = socket(AF_UNIX, SOCK_STREAM, 0);
+    BOOST_REQUIRE_EQUAL(bind(stale, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    close(stale);
+
+    io_service eventLoop;
+    io_service::work work(eventLoop);
+    InterfaceServer server(eventLoop, ImplPtr(new SysfsInterfaceManagerImpl(net, 10)), socketPath);
+    server.start();
+    boost::thread loop(boost::bind(&io_service::run, &eventLoop));
+
+    LineClient snapshot(socketPath);
+    snapshot.send(SERVER_REQUEST_SNAPSHOT "\n");
+    BOOST_CHECK(snapshot.readReply() == std::vector<std::string>{"IFACE eth0 00:11:22:AA:BB:CC Ethernet"});
+
+    /**< A subscriber that has shut down its sending side keeps getting updates */
+    LineClient subscriber(socketPath);
+    subscriber.send(SERVER_REQUEST_SUBSCRIBE "\n");
+    shutdown(subscriber.fd, SHUT_WR);
+    BOOST_CHECK_EQUAL(subscriber.readReply().size(), 1);
+
+    addSysfsInterface(root, "test", "1", "00:11:22:33:44:56");
+
+    std::string line;
+    BOOST_REQUIRE(subscriber.readLine(line));
+    BOOST_CHECK_EQUAL(line, "NEW test 00:11:22:33:44:56 Ethernet");
+
+    /**< Other clients are closed once the last request has been answered */
+    LineClient last(socketPath);
+    last.send(SERVER_REQUEST_SNAPSHOT);
+    shutdown(last.fd, SHUT_WR);
+    BOOST_CHECK_EQUAL(last.readReply().size(), 2);
+    BOOST_CHECK(!last.readLine(line) && last.closed);
+
+    LineClient history(socketPath);
+    history.send(SERVER_REQUEST_HISTORY " 60\n");
+    std::vector<std::string> events = history.readReply();
+    BOOST_REQUIRE_EQUAL(events.size(), 1);
+    BOOST_CHECK(events[0].find("Z NEW test 00:11:22:33:44:56 Ethernet") != std::string::npos);
+
+    /**< Malformed periods close the connection */
+    for(const char* request : {SERVER_REQUEST_HISTORY " 5x\n", SERVER_REQUEST_HISTORY " \n", SERVER_REQUEST_HISTORY "\n"})
+    {
+        LineClient invalid(socketPath);
+        invalid.send(request);
+        BOOST_CHECK(!invalid.readLine(line) && invalid.closed);
+    }
+
+    /**< A second server does not take over the socket of a running one, nor remove it */
+    {
+        io_service otherLoop;
+        InterfaceServer other(otherLoop, ImplPtr(new SysfsInterfaceManagerImpl(net, 10)), socketPath);
+        BOOST_CHECK_THROW(other.start(), std::runtime_error);
+    }
+
+    LineClient after(socketPath);
+    after.send(SERVER_REQUEST_SNAPSHOT "\n");
+    BOOST_CHECK_EQUAL(after.readReply().size(), 2);
+
+    eventLoop.stop();
+    loop.join();
+}
+
+BOOST_FIXTURE_TEST_CASE( server_queue_check, SysfsFixture )
+{
+    addSysfsInterface(root, "eth0", "1", "00:11:22:aa:bb:cc");
+    const std::string socketPath = root + "/server.sock";
+
+    /**< The backend is only polled by the test and the event loop only run by it */
+    io_service eventLoop;
+    SysfsInterfaceManagerImpl* impl = new SysfsInterfaceManagerImpl(net, 100000);
+    InterfaceServer server(eventLoop, ImplPtr(impl), socketPath, 2);
+    server.start();
+
+    auto pump = [&eventLoop]()
+    {
+        for(int i = 0; i < 20; ++i)
+        {
+            eventLoop.poll();
+            eventLoop.reset();
+            usleep(1000);
+        }
+    };
+
+    /**< An update that is on its way to the server when the subscription is handled is reported only once.
+         The request is completed by the reactor before the handler below emits the update */
+    LineClient subscriber(socketPath);
+    subscriber.send(SERVER_REQUEST_SUBSCRIBE);
+    pump();
+
+    subscriber.send("\n");
+    eventLoop.post([&]()
+    {
+        addSysfsInterface(root, "test", "1", "00:11:22:33:44:56");
+        impl->poll();
+    });
+    pump();
+
+    std::string line;
+    BOOST_CHECK_EQUAL(subscriber.readReply().size(), 2);
+    BOOST_CHECK(!subscriber.readLine(line, 100) && !subscriber.closed);
+
+    /**< A subscriber that does not read is dropped once its queue is full */
+    pollfd hangup = {subscriber.fd, 0, 0};
+    for(int i = 0; i < 100000 && poll(&hangup, 1, 0) == 0; ++i)
+    {
+        writeSysfsAttribute(root + "/devices/test/address", i % 2? "00:11:22:33:44:56" : "00:11:22:33:44:57");
+        impl->updateDevice(net + "/test");
+        eventLoop.poll();
+        eventLoop.reset();
+    }
+
+    while(subscriber.readLine(line));
+    BOOST_CHECK(subscriber.closed);
+
+    /**< The others are still served */
+    LineClient snapshot(socketPath);
+    snapshot.send(SERVER_REQUEST_SNAPSHOT "\n");
+    pump();
+    BOOST_CHECK_EQUAL(snapshot.readReply().size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE( interface_history_check )
+{
+    using boost::posix_time::seconds;
+    using boost::posix_time::milliseconds;
+
+    const HistoryTime start(boost::gregorian::date(2026, 1, 1));
+    InterfaceHistory history(HISTORY_DEFAULT_MAX_BYTES, 4);
+
+    InterfaceInfo eth;
+    eth.id = "/dev/1";
+    eth.name = "eth0";
+    eth.hwAddr = "00:11:22:33:44:55";
+    eth.type = IF_TYPE_ETH;
+
+    InterfaceInfo test = eth;
+    test.id = "/dev/2";
+    test.name = "test";
+
+    history.record(eth, true, start);
+    history.record(eth, false, start + seconds(1));
+    history.record(test, true, start + milliseconds(1500));
+    eth.hwAddr = "00:11:22:33:44:56";
+    history.record(eth, true, start + seconds(2));
+
+    HistoryEvents events = history.getRange(start, start + seconds(10));
+    BOOST_REQUIRE_EQUAL(events.size(), 4);
+    BOOST_CHECK_EQUAL(events[2].info.name, "test");
+    BOOST_CHECK_EQUAL(events[2].time, start + milliseconds(1500));
+    BOOST_CHECK_EQUAL(events[3].info.hwAddr, "00:11:22:33:44:56");
+    BOOST_CHECK(!events[1].action);
+
+    BOOST_CHECK_EQUAL(history.getRange(start + seconds(1), start + milliseconds(1500)).size(), 2);
+    BOOST_CHECK_EQUAL(history.getInterfaceHistory(eth.id).size(), 3);
+
+    /**< Only the last 4 updates of an interface are kept */
+    for(int i = 3; i < 6; ++i){
+        history.record(eth, i % 2 == 0, start + seconds(i));
+    }
+
+    events = history.getInterfaceHistory(eth.id);
+    BOOST_REQUIRE_EQUAL(events.size(), 4);
+    BOOST_CHECK_EQUAL(events.front().time, start + seconds(2));
+    BOOST_CHECK_EQUAL(events.back().time, start + seconds(5));
+
+    /**< The least recently updated interface is forgotten first */
+    history.setMaxBytes(history.getMemoryUsage() - 1);
+    BOOST_CHECK(history.getMemoryUsage() <= history.getMaxBytes());
+    BOOST_CHECK(history.getInterfaceHistory(test.id).empty());
+    BOOST_CHECK_EQUAL(history.getInterfaceHistory(eth.id).size(), 4);
+
+    /**< The only interface left loses its oldest records, strings are compacted when asked for */
+    bool fits = true;
+    for(int i = 6; i < 40; ++i)
+    {
+        eth.hwAddr = "00:11:22:33:44:" + std::to_string(i);
+        if(history.record(eth, true, start + seconds(i))){
+            history.compact();
+        }
+
+        fits = fits && history.getMemoryUsage() <= history.getMaxBytes();
+    }
+
+    BOOST_CHECK(fits);
+    events = history.getInterfaceHistory(eth.id);
+    BOOST_REQUIRE(!events.empty());
+    BOOST_CHECK_EQUAL(events.back().time, start + seconds(39));
+    BOOST_CHECK_EQUAL(events.back().info.hwAddr, eth.hwAddr);
+    BOOST_CHECK_EQUAL(events.front().time, start + seconds(40 - events.size()));
+
+    /**< A ring shrunk while wrapped keeps its order once it may grow again */
+    InterfaceHistory shrunk(1000, 256);
+    for(int i = 0; i < 200; ++i)
+    {
+        if(shrunk.record(eth, true, start + seconds(i))){
+            shrunk.compact();
+        }
+    }
+
+    shrunk.setMaxBytes(HISTORY_DEFAULT_MAX_BYTES);
+    shrunk.record(eth, false, start + seconds(210));
+
+    events = shrunk.getInterfaceHistory(eth.id);
+    BOOST_REQUIRE(events.size() > 1);
+    BOOST_CHECK_EQUAL(events.back().time, start + seconds(210));
+    BOOST_CHECK(!events.back().action);
+
+    for(size_t i = 0; i + 1 < events.size(); ++i){
+        BOOST_CHECK_EQUAL(events[i].time, start + seconds(200 - events.size() + 1 + i));
+    }
+
+    /**< The limit is enforced before the first compaction, the least recently updated interfaces are forgotten */
+    InterfaceHistory fresh(1024, 4);
+    for(int i = 0; i < 20; ++i)
+    {
+        test.id = "/dev/" + std::to_string(i);
+        fresh.record(test, true, start + seconds(i));
+    }
+
+    BOOST_CHECK(fresh.getInterfaceHistory("/dev/0").empty());
+    BOOST_CHECK_EQUAL(fresh.getInterfaceHistory("/dev/19").size(), 1);
+}
+
 #endif //TESTS_H